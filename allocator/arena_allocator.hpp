@@ -0,0 +1,130 @@
+#ifndef ARENA_ALLOCATOR_HPP
+#define ARENA_ALLOCATOR_HPP
+
+#include "bump_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+// Standard-library adaptors for the bump arena. Arena is any bump<Size,
+// Growth> (or anything with allocate(bytes, align) and deallocate(p, bytes)).
+// The arena must outlive every container that uses it.
+
+// std::pmr::memory_resource view of an arena, for std::pmr containers.
+// Deallocation is LIFO-aware: freeing the newest block gives its bytes back,
+// anything else is reclaimed when the arena is reset or rewound.
+template<typename Arena>
+class arena_resource : public std::pmr::memory_resource {
+private:
+    Arena* arena_;
+
+public:
+    explicit arena_resource(Arena& arena) : arena_(&arena) {}
+
+    Arena& arena() const { return *arena_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = arena_->allocate(bytes, alignment);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t) override {
+        arena_->deallocate(p, bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto* o = dynamic_cast<const arena_resource*>(&other);
+        return o != nullptr && o->arena_ == arena_;
+    }
+};
+
+// Stateful std Allocator over an arena, for std::vector, std::unordered_map,
+// std::basic_string and friends without the pmr virtual call.
+//
+// A container keeps its arena on copy assignment (so a copy stays in the
+// arena it was built in), but takes the source arena on move assignment and
+// swap, which makes both O(1).
+template<typename T, typename Arena>
+class arena_allocator {
+private:
+    template<typename U, typename A> friend class arena_allocator;
+
+    Arena* arena_;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template<typename U>
+    struct rebind {
+        using other = arena_allocator<U, Arena>;
+    };
+
+    explicit arena_allocator(Arena& arena) noexcept : arena_(&arena) {}
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U, Arena>& other) noexcept : arena_(other.arena_) {}
+
+    T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* p = arena_->allocate(n * sizeof(T), alignof(T));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        arena_->deallocate(p, n * sizeof(T));
+    }
+
+    Arena& arena() const noexcept { return *arena_; }
+
+    template<typename U>
+    bool operator==(const arena_allocator<U, Arena>& other) const noexcept {
+        return arena_ == other.arena_;
+    }
+
+    template<typename U>
+    bool operator!=(const arena_allocator<U, Arena>& other) const noexcept {
+        return arena_ != other.arena_;
+    }
+};
+
+// arena_allocator for memory that is only ever reclaimed in bulk, by
+// resetting or rewinding the arena. deallocate() does nothing, and
+// bulk_release tells reference-counted owners (basic_my_string, RefCounted)
+// that they may skip the call, and destructors that have no effect, when
+// the last reference goes.
+template<typename T, typename Arena>
+class bulk_arena_allocator : public arena_allocator<T, Arena> {
+public:
+    using bulk_release = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = bulk_arena_allocator<U, Arena>;
+    };
+
+    explicit bulk_arena_allocator(Arena& arena) noexcept : arena_allocator<T, Arena>(arena) {}
+
+    template<typename U>
+    bulk_arena_allocator(const bulk_arena_allocator<U, Arena>& other) noexcept
+        : arena_allocator<T, Arena>(other) {}
+
+    void deallocate(T*, size_t) noexcept {}
+};
+
+#endif // ARENA_ALLOCATOR_HPP
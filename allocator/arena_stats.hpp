@@ -0,0 +1,114 @@
+#ifndef ARENA_STATS_HPP
+#define ARENA_STATS_HPP
+
+#include "bump_allocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+// Recording statistics policy for bump:
+//
+//     bump<64 * 1024, bump_growth::fixed, arena_stats> a;
+//     ...
+//     a.stats().report(std::cout);
+//
+// Tracks the high-water mark (bytes in use, padding included - the Size a
+// fixed arena needs), bytes lost to alignment padding, failed allocations,
+// resets, rewinds, and count and bytes per call site. Allocations made through
+// arena_resource or arena_allocator are attributed to those adaptors.
+class arena_stats {
+public:
+    struct site_totals {
+        size_t allocations = 0;
+        size_t bytes = 0;
+        size_t padding = 0;
+        size_t failures = 0;
+    };
+
+private:
+    struct site_less {
+        bool operator()(const alloc_site& a, const alloc_site& b) const {
+            int order = std::strcmp(a.file, b.file);
+            return order != 0 ? order < 0 : a.line < b.line;
+        }
+    };
+
+    size_t allocations_ = 0;
+    size_t bytes_ = 0;
+    size_t padding_ = 0;
+    size_t failures_ = 0;
+    size_t resets_ = 0;
+    size_t rewinds_ = 0;
+    size_t peak_ = 0;
+    std::map<alloc_site, site_totals, site_less> sites_;
+
+public:
+    void on_allocate(size_t bytes, size_t padding, size_t in_use, const alloc_site& where) {
+        allocations_++;
+        bytes_ += bytes;
+        padding_ += padding;
+        peak_ = std::max(peak_, in_use);
+        site_totals& site = sites_[where];
+        site.allocations++;
+        site.bytes += bytes;
+        site.padding += padding;
+    }
+
+    void on_failure(size_t, const alloc_site& where) {
+        failures_++;
+        sites_[where].failures++;
+    }
+
+    void on_reset() { resets_++; }
+    void on_rewind() { rewinds_++; }
+
+    size_t allocations() const { return allocations_; }
+    size_t bytes() const { return bytes_; }
+    size_t padding_bytes() const { return padding_; }
+    size_t failures() const { return failures_; }
+    size_t resets() const { return resets_; }
+    size_t rewinds() const { return rewinds_; }
+    size_t peak_bytes() const { return peak_; }
+
+    const site_totals& site(const char* file, unsigned line) const {
+        static const site_totals none;
+        auto it = sites_.find(alloc_site{file, line});
+        return it == sites_.end() ? none : it->second;
+    }
+
+    // Forget everything recorded so far
+    void clear() {
+        *this = arena_stats();
+    }
+
+    // Summary plus one line per call site, largest byte count first
+    void report(std::ostream& out) const {
+        out << "allocations: " << allocations_ << " (" << bytes_ << " bytes)\n"
+            << "peak in use: " << peak_ << " bytes\n"
+            << "padding:     " << padding_ << " bytes\n"
+            << "failures:    " << failures_ << "\n"
+            << "resets:      " << resets_ << ", rewinds: " << rewinds_ << "\n";
+
+        std::vector<std::pair<alloc_site, site_totals>> sorted(sites_.begin(), sites_.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second.bytes > b.second.bytes;
+        });
+        for (const auto& entry : sorted) {
+            out << "  " << entry.first.file << ":" << entry.first.line
+                << "  allocations " << entry.second.allocations
+                << ", bytes " << entry.second.bytes
+                << ", padding " << entry.second.padding;
+            if (entry.second.failures > 0) {
+                out << ", failures " << entry.second.failures;
+            }
+            out << "\n";
+        }
+    }
+};
+
+#endif // ARENA_STATS_HPP
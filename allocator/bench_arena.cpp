@@ -0,0 +1,98 @@
+#include "bump_allocator.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+// Nested-scope request pattern: each request keeps a few long-lived objects
+// and runs several phases, each with its own temporaries and a nested scratch
+// scope. The arena frees each scope with one rewind(); malloc/free has to
+// release every block individually.
+
+constexpr size_t requests = 20000;
+constexpr size_t phases = 4;
+constexpr size_t temporaries = 32;
+constexpr size_t scratch = 16;
+
+volatile uint8_t sink = 0;
+
+size_t block_size(size_t i) {
+    return 16 + (i * 37) % 240;
+}
+
+template<typename Func>
+long long time_us(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+template<typename Arena>
+void run_arena(Arena& allocator) {
+    for (size_t r = 0; r < requests; r++) {
+        arena_scope<Arena> request(allocator);
+        uint8_t* header = allocator.template alloc<uint8_t>(128);
+        header[0] = 1;
+        for (size_t p = 0; p < phases; p++) {
+            arena_scope<Arena> phase(allocator);
+            for (size_t i = 0; i < temporaries; i++) {
+                uint8_t* t = allocator.template alloc<uint8_t>(block_size(i));
+                t[0] = static_cast<uint8_t>(i);
+            }
+            {
+                arena_scope<Arena> nested(allocator);
+                for (size_t i = 0; i < scratch; i++) {
+                    uint8_t* t = allocator.template alloc<uint8_t>(block_size(i + p));
+                    t[0] = static_cast<uint8_t>(i);
+                }
+            }
+        }
+        sink = header[0];
+    }
+}
+
+void run_malloc() {
+    void* temps[temporaries];
+    void* nested[scratch];
+    for (size_t r = 0; r < requests; r++) {
+        uint8_t* header = static_cast<uint8_t*>(std::malloc(128));
+        header[0] = 1;
+        for (size_t p = 0; p < phases; p++) {
+            for (size_t i = 0; i < temporaries; i++) {
+                temps[i] = std::malloc(block_size(i));
+                static_cast<uint8_t*>(temps[i])[0] = static_cast<uint8_t>(i);
+            }
+            for (size_t i = 0; i < scratch; i++) {
+                nested[i] = std::malloc(block_size(i + p));
+                static_cast<uint8_t*>(nested[i])[0] = static_cast<uint8_t>(i);
+            }
+            for (size_t i = 0; i < scratch; i++) {
+                std::free(nested[i]);
+            }
+            for (size_t i = 0; i < temporaries; i++) {
+                std::free(temps[i]);
+            }
+        }
+        sink = header[0];
+        std::free(header);
+    }
+}
+
+int main() {
+    size_t allocations = requests * (1 + phases * (temporaries + scratch));
+    std::cout << "Nested-scope pattern: " << requests << " requests, "
+              << allocations << " allocations\n";
+
+    auto fixed = std::make_unique<bump<64 * 1024>>();
+    arena<4096> chained;
+
+    long long fixed_us = time_us([&] { run_arena(*fixed); });
+    long long chained_us = time_us([&] { run_arena(chained); });
+    long long malloc_us = time_us([] { run_malloc(); });
+
+    std::cout << "bump<64K> scopes:  " << fixed_us << " µs\n";
+    std::cout << "arena<4K> scopes:  " << chained_us << " µs\n";
+    std::cout << "malloc/free:       " << malloc_us << " µs\n";
+    return 0;
+}
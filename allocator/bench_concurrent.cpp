@@ -0,0 +1,96 @@
+#include "bump_allocator.hpp"
+#include "concurrent_bump.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads filling one shared result buffer: every thread makes allocs
+// allocations of 24-72 bytes and writes into them. Compares concurrent_bump
+// used directly (one fetch_add per allocation) and through per-thread
+// local_blocks, a mutex-guarded bump, and malloc. Wall time for all threads.
+
+constexpr size_t allocs = 1000000;
+constexpr size_t arena_size = 1024 * 1024 * 1024;
+
+using shared_arena = concurrent_bump<arena_size>;
+using plain_arena = bump<arena_size>;
+
+volatile size_t sink = 0;
+
+size_t request_size(size_t i) {
+    return 24 + (i * 7) % 49;
+}
+
+template<typename Work>
+long long run(size_t threads, Work work) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    for (std::thread& w : workers) w.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    std::unique_ptr<shared_arena> shared(new shared_arena);   // Not zeroed
+    std::unique_ptr<plain_arena> plain(new plain_arena);
+    std::mutex plain_lock;
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Shared buffer fill (" << allocs << " allocations per thread)\n";
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        if (threads * allocs * 80 > arena_size) break;
+
+        shared->reset();
+        long long atomic_us = run(threads, [&] {
+            for (size_t i = 0; i < allocs; i++) {
+                char* p = shared->alloc<char>(request_size(i));
+                p[0] = 1;
+            }
+        });
+
+        shared->reset();
+        long long local_us = run(threads, [&] {
+            shared_arena::local_block local(*shared);
+            for (size_t i = 0; i < allocs; i++) {
+                char* p = local.alloc<char>(request_size(i));
+                p[0] = 1;
+            }
+        });
+
+        plain->reset();
+        long long mutex_us = run(threads, [&] {
+            for (size_t i = 0; i < allocs; i++) {
+                char* p;
+                {
+                    std::lock_guard<std::mutex> guard(plain_lock);
+                    p = plain->alloc<char>(request_size(i));
+                }
+                p[0] = 1;
+            }
+        });
+
+        long long malloc_us = run(threads, [&] {
+            std::vector<char*> blocks;
+            blocks.reserve(allocs);
+            for (size_t i = 0; i < allocs; i++) {
+                char* p = static_cast<char*>(std::malloc(request_size(i)));
+                p[0] = 1;
+                blocks.push_back(p);
+            }
+            sink = sink + blocks.size();
+            for (char* p : blocks) std::free(p);   // Bulk free, outside the fill
+        });
+
+        std::cout << "threads=" << threads << ": fetch_add " << atomic_us
+                  << " µs, local blocks " << local_us << " µs, mutex " << mutex_us
+                  << " µs, malloc " << malloc_us << " µs\n";
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "bump_allocator.hpp"
+#include "arena_allocator.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Container-heavy request processing: every request builds a vector, a hash
+// map of string values and a response string, then throws them all away.
+// Compares the default allocator, arena_allocator over a chained arena,
+// std::pmr containers over arena_resource and std::pmr::monotonic_buffer_resource.
+
+constexpr size_t requests = 20000;
+constexpr int items = 64;
+constexpr int entries = 32;
+
+volatile size_t sink = 0;
+
+template<typename Func>
+long long time_us(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// One request over containers built from alloc (a std Allocator or a
+// std::pmr::polymorphic_allocator)
+template<typename String, typename Vector, typename Map, typename Alloc>
+size_t process_request(size_t r, const Alloc& alloc) {
+    Vector values(alloc);
+    for (int i = 0; i < items; i++) {
+        values.push_back(static_cast<int>(r) + i);
+    }
+
+    Map map(entries, std::hash<int>(), std::equal_to<int>(), alloc);
+    for (int i = 0; i < entries; i++) {
+        String value("value for a key that does not fit inline ", alloc);
+        value += static_cast<char>('a' + i % 26);
+        map.emplace(values[i], std::move(value));
+    }
+
+    String response(alloc);
+    for (int i = 0; i < entries; i += 4) {
+        response += map.find(values[i])->second;
+        response += ';';
+    }
+    return response.size() + values.size() + map.size();
+}
+
+void run_default() {
+    for (size_t r = 0; r < requests; r++) {
+        std::allocator<char> alloc;
+        sink = sink + process_request<std::string, std::vector<int>,
+                                      std::unordered_map<int, std::string>>(r, alloc);
+    }
+}
+
+void run_arena_allocator() {
+    using arena_type = arena<64 * 1024>;
+    using alloc_type = arena_allocator<char, arena_type>;
+    using string_type = std::basic_string<char, std::char_traits<char>, alloc_type>;
+    using vector_type = std::vector<int, arena_allocator<int, arena_type>>;
+    using map_type = std::unordered_map<int, string_type, std::hash<int>, std::equal_to<int>,
+        arena_allocator<std::pair<const int, string_type>, arena_type>>;
+
+    arena_type a;
+    for (size_t r = 0; r < requests; r++) {
+        alloc_type alloc(a);
+        sink = sink + process_request<string_type, vector_type, map_type>(r, alloc);
+        a.reset();
+    }
+}
+
+void run_pmr(std::pmr::memory_resource& resource, const std::function<void()>& release) {
+    for (size_t r = 0; r < requests; r++) {
+        std::pmr::polymorphic_allocator<char> alloc(&resource);
+        sink = sink + process_request<std::pmr::string, std::pmr::vector<int>,
+                                      std::pmr::unordered_map<int, std::pmr::string>>(r, alloc);
+        release();
+    }
+}
+
+int main() {
+    std::cout << "Container-heavy requests (" << requests << " requests)\n";
+
+    long long default_us = time_us([] { run_default(); });
+    long long arena_us = time_us([] { run_arena_allocator(); });
+
+    arena<64 * 1024> backing;
+    arena_resource<arena<64 * 1024>> resource(backing);
+    long long resource_us = time_us([&] {
+        run_pmr(resource, [&backing] { backing.reset(); });
+    });
+
+    std::pmr::monotonic_buffer_resource monotonic(64 * 1024);
+    long long monotonic_us = time_us([&] {
+        run_pmr(monotonic, [&monotonic] { monotonic.release(); });
+    });
+
+    std::cout << "std::allocator:                 " << default_us << " µs\n";
+    std::cout << "arena_allocator:                " << arena_us << " µs\n";
+    std::cout << "pmr + arena_resource:           " << resource_us << " µs\n";
+    std::cout << "pmr + monotonic_buffer_resource: " << monotonic_us << " µs\n";
+    return 0;
+}
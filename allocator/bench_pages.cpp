@@ -0,0 +1,85 @@
+#include "bump_allocator.hpp"
+#include "page_source.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Random access over a large arena on normal pages, transparent huge pages
+// and hugetlbfs pages, with and without prefaulting. "setup" is the time to
+// get the memory and write it once; "random" is a dependent pointer chase
+// through it, which is dominated by TLB and cache misses.
+
+constexpr size_t arena_bytes = 256 * 1024 * 1024;
+constexpr size_t chase_steps = 10000000;
+
+volatile uint64_t sink = 0;
+
+// AnonHugePages of this process, in kB (-1 if unavailable)
+long anon_huge_kb() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(smaps, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            return std::stol(line.substr(14));
+        }
+    }
+    return -1;
+}
+
+template<typename Func>
+long long time_us(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+void run(page_mode mode, bool populate) {
+    page_source pages(mode, populate);
+    arena<arena_bytes> a(pages);
+    size_t count = arena_bytes / sizeof(uint64_t);
+    uint64_t* slots = nullptr;
+
+    // Single-cycle random permutation (Sattolo) so the chase visits every slot
+    long long setup_us = time_us([&] {
+        slots = a.alloc<uint64_t>(count);
+        for (size_t i = 0; i < count; i++) slots[i] = i;
+    });
+    uint64_t state = 88172645463325252ull;
+    for (size_t i = count - 1; i > 0; i--) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t j = state % i;
+        uint64_t t = slots[i];
+        slots[i] = slots[j];
+        slots[j] = t;
+    }
+
+    long huge_kb = anon_huge_kb();
+    long long random_us = time_us([&] {
+        uint64_t at = 0;
+        for (size_t i = 0; i < chase_steps; i++) at = slots[at];
+        sink = at;
+    });
+
+    std::cout << page_mode_name(mode) << (populate ? " + populate" : "")
+              << " -> got " << page_mode_name(pages.obtained())
+              << ": setup " << setup_us << " µs, random " << random_us << " µs";
+    if (huge_kb >= 0) std::cout << ", AnonHugePages " << huge_kb / 1024 << " MB";
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "Random access (" << arena_bytes / (1024 * 1024) << " MB arena, "
+              << chase_steps << " dependent loads)\n";
+    page_mode modes[] = {page_mode::normal, page_mode::transparent_huge, page_mode::huge_tlb};
+    for (page_mode mode : modes) {
+        run(mode, false);
+        run(mode, true);
+    }
+    return 0;
+}
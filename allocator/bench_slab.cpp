@@ -0,0 +1,126 @@
+#include "bump_allocator.hpp"
+#include "slab_allocator.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Random alloc/free churn over a fixed set of live slots: each step picks a
+// slot and frees it if occupied, otherwise allocates 16-512 bytes. Compares
+// the slab allocator, malloc and a chained bump arena. The arena cannot free
+// individual blocks, so it is reset whenever it passes reset_bytes - the
+// best case for a bump allocator under this pattern.
+
+constexpr size_t slots = 4096;
+constexpr size_t steps = 2000000;
+constexpr size_t reset_bytes = 8 * 1024 * 1024;
+
+volatile size_t sink = 0;
+
+struct step {
+    uint32_t slot;
+    uint32_t bytes;
+};
+
+std::vector<step> make_steps(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> slot(0, slots - 1);
+    std::uniform_int_distribution<uint32_t> bytes(16, 512);
+    std::vector<step> out(steps);
+    for (step& s : out) {
+        s = {slot(rng), bytes(rng)};
+    }
+    return out;
+}
+
+template<typename Alloc, typename Free>
+long long churn(const std::vector<step>& plan, Alloc alloc, Free release) {
+    std::vector<void*> live(slots, nullptr);
+    std::vector<uint32_t> sizes(slots, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (const step& s : plan) {
+        if (live[s.slot] != nullptr) {
+            release(live[s.slot], sizes[s.slot]);
+            live[s.slot] = nullptr;
+        } else {
+            void* p = alloc(s.bytes);
+            std::memset(p, 1, 16);
+            live[s.slot] = p;
+            sizes[s.slot] = s.bytes;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < slots; i++) {
+        if (live[i] != nullptr) release(live[i], sizes[i]);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+long long run_slab(slab_heap<>& heap, const std::vector<step>& plan) {
+    slab_cache<> cache(heap);
+    return churn(plan,
+        [&](size_t bytes) { return cache.allocate(bytes); },
+        [&](void* p, size_t bytes) { cache.deallocate(p, bytes); });
+}
+
+long long run_malloc(const std::vector<step>& plan) {
+    return churn(plan,
+        [](size_t bytes) { return std::malloc(bytes); },
+        [](void* p, size_t) { std::free(p); });
+}
+
+long long run_bump(const std::vector<step>& plan) {
+    arena<64 * 1024> a;
+    return churn(plan,
+        [&](size_t bytes) {
+            if (a.get_current_pos() > reset_bytes) {
+                a.reset();  // Pretend every live block died here
+            }
+            return a.allocate(bytes, 16);
+        },
+        [&](void* p, size_t bytes) { a.deallocate(p, bytes); });
+}
+
+// Every thread churns its own plan through its own slab_cache or malloc
+template<typename Run>
+long long threaded(size_t threads, Run run) {
+    std::vector<std::vector<step>> plans;
+    for (size_t t = 0; t < threads; t++) {
+        plans.push_back(make_steps(static_cast<unsigned>(t + 1)));
+    }
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] { sink = sink + run(plans[t]); });
+    }
+    for (std::thread& w : workers) w.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    std::vector<step> plan = make_steps(1);
+    std::cout << "Random churn (" << steps << " steps over " << slots << " slots)\n";
+
+    slab_heap<> heap;
+    run_slab(heap, plan);   // Warm the heap's slabs
+    std::cout << "slab:   " << run_slab(heap, plan) << " µs\n";
+    std::cout << "malloc: " << run_malloc(plan) << " µs\n";
+    std::cout << "bump:   " << run_bump(plan) << " µs (reset every "
+              << reset_bytes / (1024 * 1024) << " MB, frees mostly ignored)\n";
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\nThreads churning in parallel (wall time)\n";
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        long long slab_us = threaded(threads, [&](const std::vector<step>& p) {
+            return run_slab(heap, p);
+        });
+        long long malloc_us = threaded(threads, run_malloc);
+        std::cout << "threads=" << threads << ": slab " << slab_us
+                  << " µs, malloc " << malloc_us << " µs\n";
+    }
+    return 0;
+}
@@ -3,54 +3,459 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <type_traits>
+#include <utility>
 
+// How a bump arena behaves once its memory is used up
+enum class bump_growth {
+    fixed,      // One inline buffer of Size bytes; alloc fails when full
+    chained     // Chunks (heap by default), starting at Size bytes and doubling
+};
+
+// Position of a bump arena, taken by mark() and restored by rewind()
+struct bump_marker {
+    void* chunk;                // Chained mode: chunk that was current
+    size_t pos;
+    size_t count;
+};
+
+// Where a chained arena gets its chunks from
+class chunk_source {
+public:
+    // nullptr when out of memory
+    virtual void* acquire(size_t bytes) = 0;
+    virtual void release(void* memory, size_t bytes) = 0;
+
+    // Unit that acquire() rounds requests up to (0 if none). Chained arenas
+    // size whole chunks, header included, to a multiple of it.
+    virtual size_t granularity() const { return 0; }
+
+protected:
+    ~chunk_source() = default;
+};
+
+// Default source: the global heap
+class heap_chunk_source final : public chunk_source {
+public:
+    void* acquire(size_t bytes) override { return std::malloc(bytes); }
+    void release(void* memory, size_t) override { std::free(memory); }
+
+    static heap_chunk_source& instance() {
+        static heap_chunk_source source;
+        return source;
+    }
+};
+
+namespace bump_detail {
+
+// Fixed mode: the whole buffer lives inside the allocator object
 template<size_t Size>
-class bump {
-private:
+struct inline_storage {
     alignas(std::max_align_t) uint8_t buffer[Size];
+
+    uint8_t* base() { return buffer; }
+    size_t capacity() const { return Size; }
+};
+
+// Chained mode: a list of chunks from a chunk_source, newest first. Only the newest chunk
+// is bumped; older ones stay alive until reset().
+class chunk_storage {
+private:
+    struct alignas(std::max_align_t) chunk {
+        chunk* prev;
+        size_t size;
+
+        uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    chunk_source* source_ = &heap_chunk_source::instance();
+    chunk* head_ = nullptr;
+    chunk* spare_ = nullptr;        // Largest chunk dropped by rewind(), reused by grow()
+    uint8_t* base_ = nullptr;       // head_->data(), cached for the fast path
+    size_t capacity_ = 0;
+    size_t reserved_ = 0;           // Bytes across all chunks, spare included
+
+public:
+    chunk_storage() = default;
+    explicit chunk_storage(chunk_source& source) : source_(&source) {}
+
+    chunk_storage(const chunk_storage&) = delete;
+    chunk_storage& operator=(const chunk_storage&) = delete;
+
+    ~chunk_storage() {
+        release_all();
+    }
+
+    uint8_t* base() { return base_; }
+    size_t capacity() const { return capacity_; }
+    size_t reserved() const { return reserved_; }
+    size_t spare() const { return spare_ ? spare_->size : 0; }
+    void* current() const { return head_; }
+
+    // Only while no chunk (not even a spare) is held
+    void set_source(chunk_source& source) { source_ = &source; }
+
+    // Push a chunk of at least min_size bytes, at least double the current
+    // one. Returns false only if the source is out of memory.
+    bool grow(size_t initial_size, size_t min_size) {
+        if (spare_ != nullptr && spare_->size >= min_size) {
+            chunk* c = spare_;
+            spare_ = nullptr;
+            push(c);
+            return true;
+        }
+        size_t size = head_ ? head_->size * 2 : initial_size;
+        if (size < min_size) {
+            size = min_size;
+        }
+        if (size > SIZE_MAX - sizeof(chunk)) {
+            return false;
+        }
+        if (size_t unit = source_->granularity()) {
+            // The nearest whole number of units that still holds min_size,
+            // so the header does not spill into a unit of its own
+            if (size > SIZE_MAX - sizeof(chunk) - unit) {
+                return false;
+            }
+            size_t total = (sizeof(chunk) + size + unit / 2) / unit * unit;
+            if (total < sizeof(chunk) + min_size) {
+                total = (sizeof(chunk) + min_size + unit - 1) / unit * unit;
+            }
+            size = total - sizeof(chunk);
+        }
+        void* memory = source_->acquire(sizeof(chunk) + size);
+        if (memory == nullptr) {
+            return false;
+        }
+        chunk* c = static_cast<chunk*>(memory);
+        c->size = size;
+        reserved_ += size;
+        push(c);
+        return true;
+    }
+
+    // Make target (a chunk returned by current(), or nullptr for "before the
+    // first chunk") current again. Newer chunks are dropped, keeping the
+    // largest one as a spare so a rewind loop does not hit malloc every time.
+    void rewind_to(void* target) {
+        while (head_ != target) {
+            chunk* c = head_;
+            head_ = c->prev;
+            if (spare_ == nullptr || c->size > spare_->size) {
+                std::swap(c, spare_);
+            }
+            if (c != nullptr) {
+                reserved_ -= c->size;
+                free_chunk(c);
+            }
+        }
+        set_current(head_);
+    }
+
+    // rewind_to() the first chunk, so every chunk a marker can still name
+    // when nothing is allocated stays alive
+    void rewind_to_oldest() {
+        chunk* oldest = head_;
+        while (oldest != nullptr && oldest->prev != nullptr) {
+            oldest = oldest->prev;
+        }
+        rewind_to(oldest);
+    }
+
+    // Free every chunk except the largest, which becomes the only chunk
+    void keep_largest() {
+        if (spare_ != nullptr) {
+            spare_->prev = head_;
+            head_ = spare_;
+            spare_ = nullptr;
+        }
+        chunk* largest = head_;
+        for (chunk* c = head_; c != nullptr; c = c->prev) {
+            if (c->size > largest->size) {
+                largest = c;
+            }
+        }
+        chunk* c = head_;
+        while (c != nullptr) {
+            chunk* prev = c->prev;
+            if (c != largest) {
+                free_chunk(c);
+            }
+            c = prev;
+        }
+        head_ = largest;
+        if (largest != nullptr) {
+            largest->prev = nullptr;
+            reserved_ = largest->size;
+        }
+        set_current(head_);
+    }
+
+    void release_all() {
+        while (head_ != nullptr) {
+            chunk* prev = head_->prev;
+            free_chunk(head_);
+            head_ = prev;
+        }
+        if (spare_ != nullptr) {
+            free_chunk(spare_);
+            spare_ = nullptr;
+        }
+        set_current(nullptr);
+        reserved_ = 0;
+    }
+
+private:
+    void free_chunk(chunk* c) {
+        source_->release(c, sizeof(chunk) + c->size);
+    }
+
+    void push(chunk* c) {
+        c->prev = head_;
+        head_ = c;
+        set_current(c);
+    }
+
+    void set_current(chunk* c) {
+        base_ = c ? c->data() : nullptr;
+        capacity_ = c ? c->size : 0;
+    }
+};
+
+} // namespace bump_detail
+
+// Source location of an allocation. alloc() and allocate() take one as a
+// defaulted last argument, so it is filled in at the caller's line.
+struct alloc_site {
+    const char* file;
+    unsigned line;
+
+    static constexpr alloc_site here(const char* file = __builtin_FILE(),
+                                     unsigned line = __builtin_LINE()) {
+        return {file, line};
+    }
+};
+
+// Statistics policy that records nothing. Every hook is an empty inline
+// function, so a bump without stats compiles to the same code as before.
+// arena_stats (arena_stats.hpp) is the recording policy.
+struct no_stats {
+    // bytes requested, padding inserted before them, bytes in use afterwards
+    void on_allocate(size_t, size_t, size_t, const alloc_site&) {}
+    void on_failure(size_t, const alloc_site&) {}
+    void on_reset() {}
+    void on_rewind() {}
+};
+
+template<size_t Size, bump_growth Growth = bump_growth::fixed, typename Stats = no_stats>
+class bump : private Stats {
+private:
+    static constexpr bool chained = Growth == bump_growth::chained;
+
+    using storage_type = typename std::conditional<chained,
+        bump_detail::chunk_storage,
+        bump_detail::inline_storage<Size>>::type;
+
+    storage_type storage;
     size_t current_pos = 0;
     size_t allocation_count = 0;
 
 public:
+    bump() = default;
+
+    // Chained mode: take chunks from source instead of the heap
+    template<bump_growth G = Growth,
+             typename = typename std::enable_if<G == bump_growth::chained>::type>
+    explicit bump(chunk_source& source) : storage(source) {}
+
     template<typename T>
-    T* alloc(size_t count = 1) {
-        // Calculate required alignment
-        size_t align = alignof(T);
-        size_t padding = (align - (current_pos % align)) % align;
-        size_t required_size = sizeof(T) * count + padding;
-        
-        // Check if we have enough space
-        if (current_pos + required_size > Size) {
+    T* alloc(size_t count = 1, alloc_site where = alloc_site::here()) {
+        if (count > SIZE_MAX / sizeof(T)) {
+            Stats::on_failure(SIZE_MAX, where);
             return nullptr;
         }
-        
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T), where));
+    }
+
+    // Untyped allocation; align must be a power of two
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t),
+                   alloc_site where = alloc_site::here()) {
+        // Calculate required alignment from the actual address
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.base()) + current_pos;
+        size_t padding = (align - (address & (align - 1))) & (align - 1);
+
+        // Check if we have enough space
+        if (padding > storage.capacity() - current_pos ||
+            bytes > storage.capacity() - current_pos - padding ||
+            (chained && storage.base() == nullptr)) {
+            if constexpr (chained) {
+                return allocate_slow(bytes, align, where);
+            } else {
+                Stats::on_failure(bytes, where);
+                return nullptr;
+            }
+        }
+
         // Apply padding
         current_pos += padding;
-        
+
         // Get pointer to allocated memory
-        T* result = reinterpret_cast<T*>(&buffer[current_pos]);
-        
+        void* result = storage.base() + current_pos;
+
         // Update position and count
-        current_pos += sizeof(T) * count;
+        current_pos += bytes;
         allocation_count++;
-        
+
+        Stats::on_allocate(bytes, padding, in_use(), where);
         return result;
     }
-    
+
+    // Untyped release. Memory is reclaimed immediately only if p is the most
+    // recent allocation; otherwise this just counts down like dealloc().
+    void deallocate(void* p, size_t bytes) {
+        uint8_t* top = storage.base() + current_pos;
+        if (static_cast<uint8_t*>(p) + bytes == top && bytes <= current_pos) {
+            current_pos -= bytes;
+        }
+        dealloc();
+    }
+
+    // Counting down to 0 empties the arena like reset(), but a chained arena
+    // only rewinds to its first chunk (keeping the largest newer one as the
+    // spare), so markers taken on that chunk stay valid
     void dealloc() {
         if (allocation_count > 0) {
             allocation_count--;
             if (allocation_count == 0) {
-                current_pos = 0;  // Reset only when all allocations are deallocated
+                if constexpr (chained) {
+                    storage.rewind_to_oldest();
+                }
+                current_pos = 0;
+                Stats::on_reset();
+            }
+        }
+    }
+
+    // Current position, to hand back to rewind()
+    bump_marker mark() const {
+        if constexpr (chained) {
+            return {storage.current(), current_pos, allocation_count};
+        } else {
+            return {nullptr, current_pos, allocation_count};
+        }
+    }
+
+    // Free everything allocated since m in one step. Markers must be rewound
+    // in LIFO order; rewinding to an older marker invalidates newer ones, and
+    // reset() and release() invalidate all of them.
+    void rewind(const bump_marker& m) {
+        if constexpr (chained) {
+            if (storage.current() != m.chunk) {
+                storage.rewind_to(m.chunk);
             }
         }
+        current_pos = m.pos;
+        allocation_count = m.count;
+        Stats::on_rewind();
+    }
+
+    // Drop every allocation at once. Chained arenas keep their largest chunk
+    // so the next cycle usually never leaves the fast path.
+    void reset() {
+        if constexpr (chained) {
+            storage.keep_largest();
+        }
+        current_pos = 0;
+        allocation_count = 0;
+        Stats::on_reset();
+    }
+
+    // Drop every allocation and, in chained mode, return all chunks to the
+    // source
+    void release() {
+        if constexpr (chained) {
+            storage.release_all();
+        }
+        current_pos = 0;
+        allocation_count = 0;
+        Stats::on_reset();
+    }
+
+    // Chained mode, while release()d: take future chunks from source
+    void set_source(chunk_source& source) {
+        static_assert(chained, "only chained arenas have a chunk source");
+        storage.set_source(source);
     }
-    
+
     // For testing/debugging
     size_t get_current_pos() const { return current_pos; }
     size_t get_allocation_count() const { return allocation_count; }
-    size_t get_available_space() const { return Size - current_pos; }
+    size_t get_available_space() const { return storage.capacity() - current_pos; }
+
+    // Bytes of backing memory currently held
+    size_t get_reserved() const {
+        if constexpr (chained) {
+            return storage.reserved();
+        } else {
+            return Size;
+        }
+    }
+
+    // The statistics policy, e.g. to print an arena_stats report
+    const Stats& stats() const { return *this; }
+    Stats& stats() { return *this; }
+
+private:
+    // Fixed mode: the bump position. Chained mode: every earlier chunk
+    // counts as full, plus the position in the current one. The spare kept
+    // by rewind() is reserved but holds nothing.
+    size_t in_use() const {
+        if constexpr (chained) {
+            return storage.reserved() - storage.spare() - storage.capacity() + current_pos;
+        } else {
+            return current_pos;
+        }
+    }
+
+    // Current chunk is full: chain a bigger one and bump from its start
+    void* allocate_slow(size_t bytes, size_t align, const alloc_site& where) {
+        if (bytes > SIZE_MAX - align || !storage.grow(Size, bytes + align)) {
+            Stats::on_failure(bytes, where);
+            return nullptr;
+        }
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.base());
+        size_t padding = (align - (address & (align - 1))) & (align - 1);
+        current_pos = padding;
+        void* result = storage.base() + current_pos;
+        current_pos += bytes;
+        allocation_count++;
+        Stats::on_allocate(bytes, padding, in_use(), where);
+        return result;
+    }
+};
+
+// Rewinds an arena to the position it had when the scope was entered
+template<typename Arena>
+class arena_scope {
+private:
+    Arena& arena_;
+    bump_marker marker_;
+
+public:
+    explicit arena_scope(Arena& arena) : arena_(arena), marker_(arena.mark()) {}
+
+    ~arena_scope() {
+        arena_.rewind(marker_);
+    }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
 };
 
-#endif // BUMP_ALLOCATOR_HPP 
\ No newline at end of file
+// Growable arena: starts with an InitialSize heap chunk and never embeds its
+// buffer, so it is cheap to place on the stack
+template<size_t InitialSize = 64 * 1024>
+using arena = bump<InitialSize, bump_growth::chained>;
+
+#endif // BUMP_ALLOCATOR_HPP
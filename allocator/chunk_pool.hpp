@@ -0,0 +1,102 @@
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+#include "bump_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Single-threaded cache of arena chunks in front of another chunk_source.
+//
+// Released chunks are kept on a free list per size (chained arenas request
+// a handful of distinct sizes), up to max_cached_bytes in total, and handed
+// straight back by the next acquire() of the same size. Meant to be owned by
+// one worker thread so its arenas recycle memory without touching the
+// global heap.
+class chunk_pool final : public chunk_source {
+private:
+    static constexpr size_t bucket_count = 16;
+
+    struct free_chunk {
+        free_chunk* next;
+    };
+
+    struct bucket {
+        size_t bytes = 0;           // 0 while unused
+        free_chunk* head = nullptr;
+    };
+
+    chunk_source* upstream_;
+    size_t max_cached_bytes_;
+    size_t cached_bytes_ = 0;
+    bucket buckets_[bucket_count];
+
+public:
+    explicit chunk_pool(size_t max_cached_bytes = 4 * 1024 * 1024,
+                        chunk_source& upstream = heap_chunk_source::instance())
+        : upstream_(&upstream), max_cached_bytes_(max_cached_bytes) {}
+
+    ~chunk_pool() {
+        trim();
+    }
+
+    chunk_pool(const chunk_pool&) = delete;
+    chunk_pool& operator=(const chunk_pool&) = delete;
+
+    void* acquire(size_t bytes) override {
+        for (bucket& b : buckets_) {
+            if (b.bytes == bytes && b.head != nullptr) {
+                free_chunk* c = b.head;
+                b.head = c->next;
+                cached_bytes_ -= bytes;
+                return c;
+            }
+        }
+        return upstream_->acquire(bytes);
+    }
+
+    void release(void* memory, size_t bytes) override {
+        if (cached_bytes_ + bytes <= max_cached_bytes_ && bytes >= sizeof(free_chunk)) {
+            bucket* slot = nullptr;
+            for (bucket& b : buckets_) {
+                if (b.bytes == bytes) {
+                    slot = &b;
+                    break;
+                }
+                if (slot == nullptr && b.head == nullptr) {
+                    slot = &b;
+                }
+            }
+            if (slot != nullptr) {
+                slot->bytes = bytes;
+                free_chunk* c = static_cast<free_chunk*>(memory);
+                c->next = slot->head;
+                slot->head = c;
+                cached_bytes_ += bytes;
+                return;
+            }
+        }
+        upstream_->release(memory, bytes);
+    }
+
+    size_t granularity() const override {
+        return upstream_->granularity();
+    }
+
+    // Give every cached chunk back to the upstream source
+    void trim() {
+        for (bucket& b : buckets_) {
+            while (b.head != nullptr) {
+                free_chunk* c = b.head;
+                b.head = c->next;
+                upstream_->release(c, b.bytes);
+            }
+            b.bytes = 0;
+        }
+        cached_bytes_ = 0;
+    }
+
+    size_t cached_bytes() const { return cached_bytes_; }
+};
+
+#endif // CHUNK_POOL_HPP
@@ -0,0 +1,146 @@
+#ifndef CONCURRENT_BUMP_HPP
+#define CONCURRENT_BUMP_HPP
+
+#include "bump_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size bump arena that any number of threads may allocate from at once.
+//
+// allocate() reserves space with a single fetch_add on the shared offset,
+// never a CAS loop: requests aligned to at most 16 bytes are rounded up to a
+// multiple of 16 so every reservation starts 16-byte aligned, and larger
+// alignments reserve align - 1 extra bytes and align inside the reservation.
+// A thread that allocates often should carve through a local_block instead,
+// which takes block_size bytes from the arena at a time and bumps privately
+// inside them, so the shared cache line is touched once per block.
+//
+// reset() is a bulk free and must only run while no thread is allocating.
+// It advances the arena's epoch so that every local_block notices on its
+// next allocation that its block is stale and fetches a fresh one.
+template<size_t Size>
+class concurrent_bump {
+private:
+    static constexpr size_t granule = 16;
+    static_assert(alignof(std::max_align_t) <= granule, "granule must cover max_align_t");
+
+    bump_detail::inline_storage<Size> storage;
+    alignas(64) std::atomic<size_t> offset_{0};     // May run past Size once full
+    alignas(64) std::atomic<uint64_t> epoch_{0};
+
+public:
+    class local_block;
+
+    concurrent_bump() = default;
+
+    concurrent_bump(const concurrent_bump&) = delete;
+    concurrent_bump& operator=(const concurrent_bump&) = delete;
+
+    template<typename T>
+    T* alloc(size_t count = 1) {
+        if (count > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Any thread; align must be a power of two. nullptr once the arena is full.
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        if (bytes > Size) {
+            return nullptr;
+        }
+        size_t reserve = (bytes + granule - 1) & ~(granule - 1);
+        if (align > granule) {
+            reserve += align - granule;
+        }
+        size_t start = offset_.fetch_add(reserve, std::memory_order_relaxed);
+        if (reserve > Size || start > Size - reserve) {
+            return nullptr;
+        }
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.base() + start);
+        address = (address + align - 1) & ~(uintptr_t(align) - 1);
+        return reinterpret_cast<void*>(address);
+    }
+
+    // Drop every allocation. Only while no thread is allocating; the caller
+    // must order this with the other threads (join, barrier, ...).
+    void reset() {
+        offset_.store(0, std::memory_order_relaxed);
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t epoch() const { return epoch_.load(std::memory_order_relaxed); }
+
+    // Bytes handed out so far, padding included
+    size_t get_used() const {
+        size_t used = offset_.load(std::memory_order_relaxed);
+        return used < Size ? used : Size;
+    }
+
+    size_t get_available_space() const { return Size - get_used(); }
+
+    static constexpr size_t capacity() { return Size; }
+};
+
+// One thread's window into a concurrent_bump. Allocation is a plain bump
+// inside the current block; only a refill touches the shared arena. Space
+// left at the end of a block when a request does not fit is wasted.
+template<size_t Size>
+class concurrent_bump<Size>::local_block {
+private:
+    concurrent_bump* arena_;
+    size_t block_size_;
+    uint8_t* pos_ = nullptr;
+    uint8_t* end_ = nullptr;
+    uint64_t epoch_ = 0;
+
+public:
+    explicit local_block(concurrent_bump& arena, size_t block_size = 16 * 1024)
+        : arena_(&arena), block_size_(block_size) {}
+
+    local_block(const local_block&) = delete;
+    local_block& operator=(const local_block&) = delete;
+
+    template<typename T>
+    T* alloc(size_t count = 1) {
+        if (count > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Owner thread only
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(pos_);
+        size_t padding = (align - (address & (align - 1))) & (align - 1);
+        if (pos_ == nullptr || padding > static_cast<size_t>(end_ - pos_) ||
+            bytes > static_cast<size_t>(end_ - pos_) - padding ||
+            epoch_ != arena_->epoch()) {
+            return refill(bytes, align);
+        }
+        void* result = pos_ + padding;
+        pos_ += padding + bytes;
+        return result;
+    }
+
+private:
+    void* refill(size_t bytes, size_t align) {
+        // Requests bigger than a block go straight to the arena
+        if (bytes + align > block_size_) {
+            return arena_->allocate(bytes, align);
+        }
+        epoch_ = arena_->epoch();
+        uint8_t* block = static_cast<uint8_t*>(arena_->allocate(block_size_, granule));
+        if (block == nullptr) {
+            pos_ = end_ = nullptr;
+            return nullptr;
+        }
+        pos_ = block;
+        end_ = block + block_size_;
+        return allocate(bytes, align);
+    }
+};
+
+#endif // CONCURRENT_BUMP_HPP
@@ -0,0 +1,140 @@
+#ifndef DOUBLE_ENDED_ARENA_HPP
+#define DOUBLE_ENDED_ARENA_HPP
+
+#include "bump_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Two bump arenas sharing one Size byte buffer. Persistent allocations grow
+// up from the bottom, temporaries grow down from the top, and either side
+// fails only once the two ends meet, so one buffer covers any split between
+// the two lifetimes.
+//
+// Each end is a small view (arena.persistent, arena.temporary) with the usual
+// alloc/allocate/mark/rewind/reset interface, so arena_scope works on either:
+//
+//     arena_scope<double_ended_arena<N>::temporary_end> frame(arena.temporary);
+template<size_t Size>
+class double_ended_arena {
+private:
+    bump_detail::inline_storage<Size> storage;
+    size_t bottom_ = 0;            // First free byte above the persistent end
+    size_t top_ = Size;            // First used byte of the temporary end
+    size_t bottom_count_ = 0;
+    size_t top_count_ = 0;
+
+    void* allocate_up(size_t bytes, size_t align) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.base() + bottom_);
+        size_t padding = (align - (address & (align - 1))) & (align - 1);
+        if (padding > top_ - bottom_ || bytes > top_ - bottom_ - padding) {
+            return nullptr;
+        }
+        void* result = storage.base() + bottom_ + padding;
+        bottom_ += padding + bytes;
+        bottom_count_++;
+        return result;
+    }
+
+    void* allocate_down(size_t bytes, size_t align) {
+        if (bytes > top_ - bottom_) {
+            return nullptr;
+        }
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.base() + top_) - bytes;
+        address &= ~(uintptr_t(align) - 1);
+        uintptr_t limit = reinterpret_cast<uintptr_t>(storage.base() + bottom_);
+        if (address < limit) {
+            return nullptr;
+        }
+        top_ = static_cast<size_t>(address - reinterpret_cast<uintptr_t>(storage.base()));
+        top_count_++;
+        return reinterpret_cast<void*>(address);
+    }
+
+    template<bool Down>
+    class end {
+    private:
+        double_ended_arena* arena_;
+
+    public:
+        explicit end(double_ended_arena* arena) : arena_(arena) {}
+
+        end(const end&) = delete;
+        end& operator=(const end&) = delete;
+
+        template<typename T>
+        T* alloc(size_t count = 1) {
+            if (count > SIZE_MAX / sizeof(T)) {
+                return nullptr;
+            }
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Untyped allocation; align must be a power of two
+        void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+            if constexpr (Down) {
+                return arena_->allocate_down(bytes, align);
+            } else {
+                return arena_->allocate_up(bytes, align);
+            }
+        }
+
+        bump_marker mark() const {
+            if constexpr (Down) {
+                return {nullptr, arena_->top_, arena_->top_count_};
+            } else {
+                return {nullptr, arena_->bottom_, arena_->bottom_count_};
+            }
+        }
+
+        // Free everything this end allocated since m, in LIFO marker order
+        void rewind(const bump_marker& m) {
+            if constexpr (Down) {
+                arena_->top_ = m.pos;
+                arena_->top_count_ = m.count;
+            } else {
+                arena_->bottom_ = m.pos;
+                arena_->bottom_count_ = m.count;
+            }
+        }
+
+        // Drop every allocation made from this end; the other end is untouched
+        void reset() {
+            rewind({nullptr, Down ? Size : 0, 0});
+        }
+
+        // Bytes this end currently holds, padding included
+        size_t get_used() const {
+            return Down ? Size - arena_->top_ : arena_->bottom_;
+        }
+
+        size_t get_allocation_count() const {
+            return Down ? arena_->top_count_ : arena_->bottom_count_;
+        }
+    };
+
+public:
+    using persistent_end = end<false>;
+    using temporary_end = end<true>;
+
+    persistent_end persistent{this};
+    temporary_end temporary{this};
+
+    double_ended_arena() = default;
+
+    double_ended_arena(const double_ended_arena&) = delete;
+    double_ended_arena& operator=(const double_ended_arena&) = delete;
+
+    // Drop both ends
+    void reset() {
+        persistent.reset();
+        temporary.reset();
+    }
+
+    // Gap between the two ends
+    size_t get_available_space() const { return top_ - bottom_; }
+
+    static constexpr size_t capacity() { return Size; }
+};
+
+#endif // DOUBLE_ENDED_ARENA_HPP
@@ -0,0 +1,202 @@
+#ifndef PAGE_SOURCE_HPP
+#define PAGE_SOURCE_HPP
+
+#include "bump_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/mman.h>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23      // Linux 5.14+
+#endif
+
+// Page-granular chunk_source that maps memory straight from the kernel,
+// optionally on huge pages to cut TLB misses on large, randomly accessed
+// arenas.
+//
+//   page_mode::huge_tlb          MAP_HUGETLB from the reserved hugetlbfs pool;
+//                                falls back to transparent_huge if the pool
+//                                is empty
+//   page_mode::transparent_huge  2MB-aligned mapping + madvise(MADV_HUGEPAGE);
+//                                falls back to normal if THP is disabled
+//                                (enabled is [never], or not built in)
+//   page_mode::normal            plain 4KB pages
+//
+// populate prefaults every chunk at acquire() so the first real access pays
+// no page faults. obtained() reports the mode the last chunk actually got,
+// chunks(mode) how many chunks each mode has served and mapped_bytes() how
+// much is mapped now.
+//
+// Huge modes round every chunk up to a whole 2MB page. Chained arenas see
+// that through granularity() and size each chunk, header included, to whole
+// pages, so an arena whose first chunk is huge_page_size bytes maps exactly
+// one huge page for it.
+enum class page_mode {
+    normal,
+    transparent_huge,
+    huge_tlb,
+};
+
+inline const char* page_mode_name(page_mode mode) {
+    switch (mode) {
+    case page_mode::normal: return "normal";
+    case page_mode::transparent_huge: return "transparent_huge";
+    case page_mode::huge_tlb: return "huge_tlb";
+    }
+    return "unknown";
+}
+
+class page_source final : public chunk_source {
+public:
+    static constexpr size_t page_size = 4096;
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+private:
+    page_mode requested_;
+    bool populate_;
+    std::atomic<page_mode> obtained_;
+    std::atomic<size_t> chunks_[3] = {};
+    std::atomic<size_t> mapped_{0};
+
+    // Mapped length for a chunk of bytes; depends only on the requested mode
+    // so release() recomputes the same value as acquire()
+    size_t mapped_length(size_t bytes) const {
+        size_t unit = granularity();
+        return (bytes + unit - 1) & ~(unit - 1);
+    }
+
+    void record(page_mode mode, size_t length) {
+        obtained_.store(mode, std::memory_order_relaxed);
+        chunks_[static_cast<int>(mode)].fetch_add(1, std::memory_order_relaxed);
+        mapped_.fetch_add(length, std::memory_order_relaxed);
+    }
+
+    // Map length bytes on a huge_page_size boundary, so THP can back the
+    // whole range, by over-mapping and trimming both ends
+    static void* map_aligned(size_t length) {
+        size_t padded = length + huge_page_size;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        size_t tail = (start + padded) - (aligned + length);
+        if (tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + length), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Fault every page in now. MADV_POPULATE_WRITE keeps THP intact; on older
+    // kernels touch one byte per page instead.
+    static void prefault(void* memory, size_t length) {
+        if (madvise(memory, length, MADV_POPULATE_WRITE) == 0) {
+            return;
+        }
+        volatile char* bytes = static_cast<volatile char*>(memory);
+        for (size_t offset = 0; offset < length; offset += page_size) {
+            bytes[offset] = 0;
+        }
+    }
+
+public:
+    explicit page_source(page_mode mode = page_mode::normal, bool populate = false)
+        : requested_(mode), populate_(populate), obtained_(mode) {}
+
+    page_source(const page_source&) = delete;
+    page_source& operator=(const page_source&) = delete;
+
+    void* acquire(size_t bytes) override {
+        size_t length = mapped_length(bytes);
+
+        if (requested_ == page_mode::huge_tlb) {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+            if (populate_) {
+                flags |= MAP_POPULATE;
+            }
+            void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (memory != MAP_FAILED) {
+                record(page_mode::huge_tlb, length);
+                return memory;
+            }
+        }
+
+        if (requested_ == page_mode::normal) {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+            if (populate_) {
+                flags |= MAP_POPULATE;
+            }
+            void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (memory == MAP_FAILED) {
+                return nullptr;
+            }
+            record(page_mode::normal, length);
+            return memory;
+        }
+
+        // Transparent huge pages, requested directly or as the fallback.
+        // Advise before prefaulting, or the faults would install 4KB pages.
+        void* memory = map_aligned(length);
+        if (memory == nullptr) {
+            return nullptr;
+        }
+        // madvise succeeds whenever THP is built in, even with it set to never
+        bool huge = transparent_huge_available() &&
+                    madvise(memory, length, MADV_HUGEPAGE) == 0;
+        if (populate_) {
+            prefault(memory, length);
+        }
+        record(huge ? page_mode::transparent_huge : page_mode::normal, length);
+        return memory;
+    }
+
+    void release(void* memory, size_t bytes) override {
+        size_t length = mapped_length(bytes);
+        munmap(memory, length);
+        mapped_.fetch_sub(length, std::memory_order_relaxed);
+    }
+
+    // Depends only on the requested mode, like mapped_length()
+    size_t granularity() const override {
+        return requested_ == page_mode::normal ? page_size : huge_page_size;
+    }
+
+    page_mode requested() const { return requested_; }
+
+    // Whether madvise(MADV_HUGEPAGE) can get huge pages: THP is built in and
+    // not set to never. Read once from sysfs.
+    static bool transparent_huge_available() {
+        static const bool available = [] {
+            FILE* enabled = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+            if (enabled == nullptr) {
+                return false;
+            }
+            char line[128] = {};
+            bool read = fgets(line, sizeof(line), enabled) != nullptr;
+            fclose(enabled);
+            return read && strstr(line, "[never]") == nullptr;
+        }();
+        return available;
+    }
+
+    // Mode of the most recent chunk (the requested mode before any acquire)
+    page_mode obtained() const { return obtained_.load(std::memory_order_relaxed); }
+
+    size_t mapped_bytes() const { return mapped_.load(std::memory_order_relaxed); }
+
+    size_t chunks(page_mode mode) const {
+        return chunks_[static_cast<int>(mode)].load(std::memory_order_relaxed);
+    }
+};
+
+#endif // PAGE_SOURCE_HPP
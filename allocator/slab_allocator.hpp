@@ -0,0 +1,335 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+
+#include "bump_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+// Size-class slab allocator for long-lived, individually freed objects.
+//
+//   slab_heap<Classes>   shared by all threads; carves slab_bytes slabs from a
+//                        chunk_source (the same memory the bump arenas use)
+//                        and keeps per-class stacks of free-object batches
+//   slab_cache<Classes>  one per thread; per-class intrusive free lists, so
+//                        alloc and free are a pointer pop/push. Refills and
+//                        flushes move a whole batch to or from the heap.
+//
+// Frees are sized (the caller passes the size it allocated), which keeps them
+// O(1) with no per-object header. Requests larger than the biggest class go
+// to malloc.
+
+// Powers of two from Min to Max bytes (Min >= 16)
+template<size_t Min = 16, size_t Max = 2048>
+struct pow2_classes {
+    static_assert(Min >= 16 && (Min & (Min - 1)) == 0, "Min must be a power of two >= 16");
+    static_assert(Max >= Min && (Max & (Max - 1)) == 0, "Max must be a power of two");
+
+    static constexpr size_t count() {
+        size_t n = 0;
+        for (size_t s = Min; s <= Max; s *= 2) n++;
+        return n;
+    }
+
+    static constexpr size_t max_size = Max;
+
+    static constexpr size_t size_of(size_t index) { return Min << index; }
+
+    // Smallest class holding bytes (bytes <= max_size)
+    static size_t index_of(size_t bytes) {
+        if (bytes <= Min) {
+            return 0;
+        }
+        size_t bits = sizeof(unsigned long long) * 8 -
+                      static_cast<size_t>(__builtin_clzll(bytes - 1));
+        return bits - static_cast<size_t>(__builtin_ctzll(Min));
+    }
+};
+
+// Explicit ascending class sizes, each a multiple of 16
+template<size_t... Sizes>
+struct custom_classes {
+    static_assert(sizeof...(Sizes) > 0, "at least one class is needed");
+
+    static constexpr size_t sizes[] = {Sizes...};
+
+    static constexpr bool valid() {
+        for (size_t i = 0; i < sizeof...(Sizes); i++) {
+            if (sizes[i] == 0 || sizes[i] % 16 != 0) return false;
+            if (i > 0 && sizes[i] <= sizes[i - 1]) return false;
+        }
+        return true;
+    }
+    static_assert(valid(), "sizes must be ascending multiples of 16");
+
+    static constexpr size_t count() { return sizeof...(Sizes); }
+
+    static constexpr size_t max_size = sizes[sizeof...(Sizes) - 1];
+
+    static constexpr size_t size_of(size_t index) { return sizes[index]; }
+
+    static size_t index_of(size_t bytes) {
+        size_t i = 0;
+        while (sizes[i] < bytes) {
+            i++;
+        }
+        return i;
+    }
+};
+
+namespace slab_detail {
+
+struct free_node {
+    free_node* next;            // Next object in the same batch
+    free_node* next_batch;      // Only meaningful on a batch's first node
+};
+
+} // namespace slab_detail
+
+template<typename Classes = pow2_classes<>>
+class slab_heap {
+public:
+    static constexpr size_t class_count = Classes::count();
+    static constexpr size_t slab_bytes = 64 * 1024;
+    static constexpr size_t batch_size = 32;
+
+private:
+    using node = slab_detail::free_node;
+
+    // Header at the start of every slab; objects follow at offset 16
+    struct slab {
+        slab* next;
+        size_t bytes;
+    };
+
+    struct alignas(64) class_list {
+        std::mutex lock;
+        node* batches = nullptr;    // Stack of full batches
+        node* loose = nullptr;      // Leftovers from partial returns
+        size_t loose_count = 0;
+    };
+
+    static_assert(Classes::size_of(0) >= sizeof(node), "smallest class must hold a free_node");
+    static_assert(sizeof(slab) == 16, "slab header must keep objects 16-byte aligned");
+
+    chunk_source* source_;
+    class_list lists_[class_count];
+    std::mutex slabs_lock_;
+    slab* slabs_ = nullptr;
+
+public:
+    explicit slab_heap(chunk_source& source = heap_chunk_source::instance())
+        : source_(&source) {}
+
+    ~slab_heap() {
+        while (slabs_ != nullptr) {
+            slab* next = slabs_->next;
+            source_->release(slabs_, slabs_->bytes);
+            slabs_ = next;
+        }
+    }
+
+    slab_heap(const slab_heap&) = delete;
+    slab_heap& operator=(const slab_heap&) = delete;
+
+    // A chain of free objects of class index (count of them), or nullptr if
+    // the source is out of memory. Normally a full batch.
+    node* fetch_batch(size_t index, size_t& count) {
+        class_list& list = lists_[index];
+        {
+            std::lock_guard<std::mutex> guard(list.lock);
+            node* batch = list.batches;
+            if (batch != nullptr) {
+                list.batches = batch->next_batch;
+                count = batch_size;
+                return batch;
+            }
+            if (list.loose != nullptr) {
+                batch = list.loose;
+                count = list.loose_count;
+                list.loose = nullptr;
+                list.loose_count = 0;
+                return batch;
+            }
+        }
+        count = batch_size;
+        return carve_slab(index);
+    }
+
+    // Take back a nullptr-terminated chain of count objects. Full batches are
+    // O(1); a partial chain is spliced onto the loose list.
+    void return_batch(size_t index, node* batch, size_t count) {
+        class_list& list = lists_[index];
+        if (count == batch_size) {
+            std::lock_guard<std::mutex> guard(list.lock);
+            batch->next_batch = list.batches;
+            list.batches = batch;
+            return;
+        }
+        node* tail = batch;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+        std::lock_guard<std::mutex> guard(list.lock);
+        tail->next = list.loose;
+        list.loose = batch;
+        list.loose_count += count;
+    }
+
+private:
+    // Cut a fresh slab into objects: hand one batch out, shelve the rest
+    node* carve_slab(size_t index) {
+        // Large classes get a slab big enough for one whole batch
+        size_t object = Classes::size_of(index);
+        size_t batches = (slab_bytes - sizeof(slab)) / (batch_size * object);
+        if (batches == 0) {
+            batches = 1;
+        }
+        size_t bytes = sizeof(slab) + batches * batch_size * object;
+        if (bytes < slab_bytes) {
+            bytes = slab_bytes;
+        }
+
+        // Under the lock so a single-threaded source like chunk_pool is safe
+        void* memory;
+        {
+            std::lock_guard<std::mutex> guard(slabs_lock_);
+            memory = source_->acquire(bytes);
+            if (memory == nullptr) {
+                return nullptr;
+            }
+            slab* s = static_cast<slab*>(memory);
+            s->bytes = bytes;
+            s->next = slabs_;
+            slabs_ = s;
+        }
+
+        uint8_t* base = static_cast<uint8_t*>(memory) + sizeof(slab);
+        node* first = nullptr;
+        for (size_t b = batches; b-- > 0;) {
+            uint8_t* start = base + b * batch_size * object;
+            node* head = nullptr;
+            for (size_t i = batch_size; i-- > 0;) {
+                node* n = reinterpret_cast<node*>(start + i * object);
+                n->next = head;
+                head = n;
+            }
+            if (b == 0) {
+                first = head;
+            } else {
+                return_batch(index, head, batch_size);
+            }
+        }
+        return first;
+    }
+};
+
+template<typename Classes = pow2_classes<>>
+class slab_cache {
+private:
+    using node = slab_detail::free_node;
+    using heap_type = slab_heap<Classes>;
+    static constexpr size_t batch_size = heap_type::batch_size;
+
+    struct free_list {
+        node* head = nullptr;
+        size_t count = 0;
+    };
+
+    heap_type* heap_;
+    free_list lists_[heap_type::class_count];
+
+public:
+    explicit slab_cache(heap_type& heap) : heap_(&heap) {}
+
+    // Hand every cached object back to the heap
+    ~slab_cache() {
+        flush();
+    }
+
+    slab_cache(const slab_cache&) = delete;
+    slab_cache& operator=(const slab_cache&) = delete;
+
+    void* allocate(size_t bytes) {
+        if (bytes > Classes::max_size) {
+            return std::malloc(bytes);
+        }
+        size_t index = Classes::index_of(bytes);
+        free_list& list = lists_[index];
+        if (list.head == nullptr) {
+            list.head = heap_->fetch_batch(index, list.count);
+            if (list.head == nullptr) {
+                list.count = 0;
+                return nullptr;
+            }
+        }
+        node* n = list.head;
+        list.head = n->next;
+        list.count--;
+        return n;
+    }
+
+    // bytes must be the size passed to allocate()
+    void deallocate(void* p, size_t bytes) {
+        if (bytes > Classes::max_size) {
+            std::free(p);
+            return;
+        }
+        size_t index = Classes::index_of(bytes);
+        free_list& list = lists_[index];
+        node* n = static_cast<node*>(p);
+        n->next = list.head;
+        list.head = n;
+        if (++list.count >= 2 * batch_size) {
+            release_batch(index);
+        }
+    }
+
+    template<typename T>
+    T* alloc() {
+        static_assert(alignof(T) <= 16, "slab objects are 16-byte aligned");
+        return static_cast<T*>(allocate(sizeof(T)));
+    }
+
+    template<typename T>
+    void dealloc(T* p) {
+        deallocate(p, sizeof(T));
+    }
+
+    // Return all cached objects to the heap, in whole batches where possible
+    void flush() {
+        for (size_t index = 0; index < heap_type::class_count; index++) {
+            free_list& list = lists_[index];
+            while (list.count >= batch_size) {
+                release_batch(index);
+            }
+            if (list.count > 0) {
+                heap_->return_batch(index, list.head, list.count);
+                list.head = nullptr;
+                list.count = 0;
+            }
+        }
+    }
+
+    // Objects of class index sitting in this cache
+    size_t cached(size_t index) const { return lists_[index].count; }
+
+private:
+    // Detach batch_size objects and give them to the heap
+    void release_batch(size_t index) {
+        free_list& list = lists_[index];
+        node* batch = list.head;
+        node* tail = batch;
+        for (size_t i = 1; i < batch_size; i++) {
+            tail = tail->next;
+        }
+        list.head = tail->next;
+        tail->next = nullptr;
+        list.count -= batch_size;
+        heap_->return_batch(index, batch, batch_size);
+    }
+};
+
+#endif // SLAB_ALLOCATOR_HPP
@@ -1,6 +1,20 @@
 #include "bump_allocator.hpp"
+#include "arena_allocator.hpp"
+#include "arena_stats.hpp"
+#include "chunk_pool.hpp"
+#include "concurrent_bump.hpp"
+#include "double_ended_arena.hpp"
+#include "page_source.hpp"
+#include "slab_allocator.hpp"
 #include <iostream>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 // Simple test framework
@@ -68,6 +82,475 @@ TEST(test_dealloc_reset) {
     std::cout << "Dealloc and reset test passed\n";
 }
 
+// Test 5.4: Chained Arena Grows Instead of Failing
+TEST(test_chained_growth) {
+    std::cout << "\n=== Test 5.4: Chained Arena Growth ===\n";
+    arena<256> allocator;
+    ASSERT(allocator.get_reserved() == 0);
+
+    // Far more than the first chunk; earlier blocks must stay intact
+    std::vector<int*> blocks;
+    for (int i = 0; i < 100; i++) {
+        int* p = allocator.alloc<int>(16);
+        ASSERT(p != nullptr);
+        for (int j = 0; j < 16; j++) {
+            p[j] = i;
+        }
+        blocks.push_back(p);
+    }
+    for (int i = 0; i < 100; i++) {
+        ASSERT(blocks[i][0] == i && blocks[i][15] == i);
+    }
+    ASSERT(allocator.get_allocation_count() == 100);
+    ASSERT(allocator.get_reserved() > 256);
+
+    // A single request bigger than any doubling step gets its own chunk
+    uint8_t* big = allocator.alloc<uint8_t>(1 << 20);
+    ASSERT(big != nullptr);
+    big[(1 << 20) - 1] = 1;
+
+    std::cout << "Chained growth test passed\n";
+}
+
+// Test 5.5: Reset Keeps the Largest Chunk
+TEST(test_chained_reset) {
+    std::cout << "\n=== Test 5.5: Chained Arena Reset ===\n";
+    arena<128> allocator;
+    for (int i = 0; i < 64; i++) {
+        ASSERT(allocator.alloc<double>(8) != nullptr);
+    }
+    size_t reserved = allocator.get_reserved();
+
+    allocator.reset();
+    size_t kept = allocator.get_reserved();
+    ASSERT(kept > 128 && kept < reserved);
+    ASSERT(allocator.get_current_pos() == 0);
+    ASSERT(allocator.get_available_space() == kept);
+
+    // The same workload now fits in the kept chunk up to its size
+    double* d = allocator.alloc<double>(8);
+    ASSERT(d != nullptr);
+    ASSERT(allocator.get_reserved() == kept);
+
+    // Over-aligned requests are honoured in every chunk
+    struct alignas(64) line { char bytes[64]; };
+    for (int i = 0; i < 20; i++) {
+        line* l = allocator.alloc<line>();
+        ASSERT(l != nullptr);
+        ASSERT(reinterpret_cast<uintptr_t>(l) % 64 == 0);
+    }
+
+    std::cout << "Chained reset test passed\n";
+}
+
+// Test 5.6: Nested Scopes Rewind in LIFO Order
+TEST(test_scoped_rewind) {
+    std::cout << "\n=== Test 5.6: Scoped Rewind ===\n";
+    bump<1024> allocator;
+
+    int* keep = allocator.alloc<int>(4);
+    ASSERT(keep != nullptr);
+    size_t outer_pos = allocator.get_current_pos();
+    {
+        arena_scope<bump<1024>> outer(allocator);
+        ASSERT(allocator.alloc<char>(3) != nullptr);
+        size_t inner_pos = allocator.get_current_pos();
+        {
+            arena_scope<bump<1024>> inner(allocator);
+            ASSERT(allocator.alloc<double>(10) != nullptr);
+        }
+        ASSERT(allocator.get_current_pos() == inner_pos);
+    }
+    ASSERT(allocator.get_current_pos() == outer_pos);
+    ASSERT(allocator.get_allocation_count() == 1);
+
+    // A long-lived allocation no longer pins memory freed by rewind()
+    bump_marker m = allocator.mark();
+    ASSERT(allocator.alloc<uint8_t>(900) != nullptr);
+    ASSERT(allocator.alloc<uint8_t>(900) == nullptr);
+    allocator.rewind(m);
+    ASSERT(allocator.alloc<uint8_t>(900) != nullptr);
+
+    std::cout << "Scoped rewind test passed\n";
+}
+
+// Test 5.7: Rewind Across Chunks of a Chained Arena
+TEST(test_chained_rewind) {
+    std::cout << "\n=== Test 5.7: Chained Rewind ===\n";
+    arena<256> allocator;
+    int* keep = allocator.alloc<int>();
+    *keep = 7;
+    bump_marker m = allocator.mark();
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 100; i++) {
+            ASSERT(allocator.alloc<uint64_t>(8) != nullptr);
+        }
+        allocator.rewind(m);
+        ASSERT(allocator.get_allocation_count() == 1);
+        ASSERT(*keep == 7);
+    }
+
+    // The dropped chunk is kept as a spare, so memory stays bounded
+    size_t reserved = allocator.get_reserved();
+    for (int round = 0; round < 10; round++) {
+        arena_scope<arena<256>> scope(allocator);
+        for (int i = 0; i < 100; i++) {
+            ASSERT(allocator.alloc<uint64_t>(8) != nullptr);
+        }
+    }
+    ASSERT(allocator.get_reserved() <= reserved);
+
+    // Counting down to zero keeps the chunk an earlier marker points into
+    arena<256> counted;
+    counted.alloc<char>(8);
+    bump_marker first = counted.mark();
+    ASSERT(counted.alloc<char>(1000) != nullptr);   // A second chunk
+    size_t two_chunks = counted.get_reserved();
+    counted.dealloc();
+    counted.dealloc();
+    ASSERT(counted.get_allocation_count() == 0 && counted.get_current_pos() == 0);
+    counted.rewind(first);
+    ASSERT(counted.get_allocation_count() == 1 && counted.get_current_pos() == 8);
+    ASSERT(counted.alloc<char>(1000) != nullptr);   // Served by the spare
+    ASSERT(counted.get_reserved() == two_chunks);
+
+    std::cout << "Chained rewind test passed\n";
+}
+
+// Test 5.8: Standard Containers on an arena_allocator
+TEST(test_std_allocator) {
+    std::cout << "\n=== Test 5.8: Standard Containers with arena_allocator ===\n";
+    using arena_type = arena<1024>;
+    using string_type = std::basic_string<char, std::char_traits<char>,
+                                          arena_allocator<char, arena_type>>;
+    arena_type a;
+    {
+        arena_allocator<int, arena_type> alloc(a);
+        std::vector<int, arena_allocator<int, arena_type>> v(alloc);
+        for (int i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+        ASSERT(v[999] == 999);
+
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                           arena_allocator<std::pair<const int, int>, arena_type>>
+            m(16, std::hash<int>(), std::equal_to<int>(), alloc);
+        for (int i = 0; i < 100; i++) {
+            m[i] = i * i;
+        }
+        ASSERT(m[9] == 81);
+
+        string_type s("a string that is too long for SSO", alloc);
+        s += " and then some";
+        ASSERT(s.size() == 47);
+
+        // Move assignment takes the source arena along
+        arena_type other;
+        arena_allocator<int, arena_type> other_alloc(other);
+        std::vector<int, arena_allocator<int, arena_type>> w(other_alloc);
+        w = std::move(v);
+        ASSERT(&w.get_allocator().arena() == &a);
+        ASSERT(w.get_allocator() == alloc);
+    }
+    ASSERT(a.get_allocation_count() == 0);
+
+    std::cout << "arena_allocator test passed\n";
+}
+
+// Test 5.9: std::pmr Containers on an arena_resource
+TEST(test_pmr_resource) {
+    std::cout << "\n=== Test 5.9: std::pmr with arena_resource ===\n";
+    bump<4096> a;
+    arena_resource<bump<4096>> resource(a);
+
+    // The newest block is given back immediately
+    void* p = resource.allocate(100, 8);
+    size_t pos = a.get_current_pos();
+    resource.deallocate(p, 100, 8);
+    ASSERT(a.get_current_pos() == pos - 100);
+
+    {
+        std::pmr::vector<std::pmr::string> names(&resource);
+        for (int i = 0; i < 20; i++) {
+            names.emplace_back("name number " + std::to_string(i) + " with padding");
+        }
+        ASSERT(names[19] == "name number 19 with padding");
+    }
+
+    // Running out of space throws, as memory_resource requires
+    bool threw = false;
+    try {
+        void* big = resource.allocate(8192, 8);
+        resource.deallocate(big, 8192, 8);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    ASSERT(threw);
+    ASSERT(resource.is_equal(arena_resource<bump<4096>>(a)));
+
+    std::cout << "arena_resource test passed\n";
+}
+
+// Test 5.10: Slab Size Classes and Reuse
+TEST(test_slab_classes) {
+    std::cout << "\n=== Test 5.10: Slab Size Classes ===\n";
+    using classes = pow2_classes<16, 1024>;
+    ASSERT(classes::count() == 7);
+    ASSERT(classes::index_of(1) == 0);
+    ASSERT(classes::index_of(16) == 0);
+    ASSERT(classes::index_of(17) == 1);
+    ASSERT(classes::index_of(1024) == 6);
+
+    using odd = custom_classes<16, 48, 96, 256>;
+    ASSERT(odd::index_of(40) == 1);
+    ASSERT(odd::index_of(97) == 3);
+
+    chunk_pool pool;
+    slab_heap<odd> heap(pool);
+    slab_cache<odd> cache(heap);
+
+    // Live objects never overlap and are 16-byte aligned
+    std::set<uintptr_t> seen;
+    void* blocks[200];
+    for (int i = 0; i < 200; i++) {
+        blocks[i] = cache.allocate(90);
+        uintptr_t addr = reinterpret_cast<uintptr_t>(blocks[i]);
+        ASSERT(addr % 16 == 0);
+        ASSERT(seen.insert(addr).second);
+        std::memset(blocks[i], i, 90);
+    }
+
+    // A freed object is the next one handed out
+    cache.deallocate(blocks[7], 90);
+    ASSERT(cache.allocate(96) == blocks[7]);
+
+    // Larger than the biggest class falls through to malloc
+    void* big = cache.allocate(4096);
+    ASSERT(big != nullptr);
+    cache.deallocate(big, 4096);
+
+    for (int i = 0; i < 200; i++) {
+        cache.deallocate(blocks[i], 90);
+    }
+    ASSERT(cache.cached(2) < 2 * slab_heap<odd>::batch_size);
+    cache.flush();
+    ASSERT(cache.cached(2) == 0);
+
+    std::cout << "Slab size class test passed\n";
+}
+
+// Test 5.11: Slab Objects Freed on Another Thread
+TEST(test_slab_threads) {
+    std::cout << "\n=== Test 5.11: Slab Across Threads ===\n";
+    slab_heap<> heap;
+    constexpr int count = 10000;
+    std::vector<int*> objects(count);
+
+    // Producer allocates, consumer frees into its own cache; the batches flow
+    // back through the heap and the producer reuses them
+    std::thread producer([&] {
+        slab_cache<> cache(heap);
+        for (int i = 0; i < count; i++) {
+            objects[i] = cache.alloc<int>();
+            *objects[i] = i;
+        }
+    });
+    producer.join();
+
+    std::thread consumer([&] {
+        slab_cache<> cache(heap);
+        for (int i = 0; i < count; i++) {
+            ASSERT(*objects[i] == i);
+            cache.dealloc(objects[i]);
+        }
+    });
+    consumer.join();
+
+    slab_cache<> cache(heap);
+    std::set<int*> recycled(objects.begin(), objects.end());
+    for (int i = 0; i < 64; i++) {
+        ASSERT(recycled.count(cache.alloc<int>()) == 1);
+    }
+
+    std::cout << "Slab thread test passed\n";
+}
+
+// Test 5.12: Double-Ended Arena
+TEST(test_double_ended) {
+    std::cout << "\n=== Test 5.12: Double-Ended Arena ===\n";
+    using arena_type = double_ended_arena<1024>;
+    auto a = std::make_unique<arena_type>();
+
+    // Both ends align correctly
+    char* c = a->persistent.alloc<char>();
+    double* d = a->persistent.alloc<double>();
+    char* t = a->temporary.alloc<char>(3);
+    double* u = a->temporary.alloc<double>();
+    ASSERT(c != nullptr && d != nullptr && t != nullptr && u != nullptr);
+    ASSERT(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0);
+    ASSERT(reinterpret_cast<uintptr_t>(u) % alignof(double) == 0);
+    ASSERT(reinterpret_cast<char*>(d) < reinterpret_cast<char*>(u));
+    ASSERT(a->persistent.get_used() == 16);
+
+    // Temporaries come and go without touching persistent data
+    *d = 1.5;
+    for (int frame = 0; frame < 100; frame++) {
+        arena_scope<arena_type::temporary_end> scope(a->temporary);
+        ASSERT(a->temporary.alloc<char>(500) != nullptr);
+    }
+    ASSERT(*d == 1.5);
+    ASSERT(a->temporary.get_allocation_count() == 2);
+
+    // Either side can use the whole gap; failure only when the ends meet
+    size_t gap = a->get_available_space();
+    ASSERT(a->persistent.alloc<char>(gap + 1) == nullptr);
+    ASSERT(a->temporary.alloc<char>(gap + 1) == nullptr);
+    ASSERT(a->temporary.alloc<char>(gap) != nullptr);
+    ASSERT(a->get_available_space() == 0);
+    ASSERT(a->persistent.alloc<char>() == nullptr);
+
+    a->temporary.reset();
+    ASSERT(a->get_available_space() == 1024 - 16);
+    a->reset();
+    ASSERT(a->get_available_space() == 1024);
+
+    std::cout << "Double-ended arena test passed\n";
+}
+
+// Test 5.13: Arenas on Kernel Pages
+TEST(test_page_source) {
+    std::cout << "\n=== Test 5.13: page_source ===\n";
+    // Falls back (to THP, then normal pages) when no hugetlb pages are reserved
+    page_mode modes[] = {page_mode::normal, page_mode::transparent_huge, page_mode::huge_tlb};
+    for (page_mode mode : modes) {
+        page_source pages(mode, true);
+        {
+            // Chunk headers fit inside the pages: the first chunk maps one
+            // huge page, the doubled second one two
+            arena<page_source::huge_page_size> a(pages);
+            ASSERT(a.alloc<char>(1024) != nullptr);
+            ASSERT(pages.mapped_bytes() == page_source::huge_page_size);
+            char* block = a.alloc<char>(3 * 1024 * 1024);
+            ASSERT(block != nullptr);
+            std::memset(block, 7, 3 * 1024 * 1024);
+            ASSERT(block[3 * 1024 * 1024 - 1] == 7);
+            ASSERT(pages.mapped_bytes() == 3 * page_source::huge_page_size);
+        }
+        ASSERT(pages.mapped_bytes() == 0);
+        size_t total = pages.chunks(page_mode::normal) +
+                       pages.chunks(page_mode::transparent_huge) +
+                       pages.chunks(page_mode::huge_tlb);
+        ASSERT(total >= 1);
+        ASSERT(pages.obtained() <= mode);
+        if (!page_source::transparent_huge_available()) {
+            ASSERT(pages.chunks(page_mode::transparent_huge) == 0);
+        }
+        std::cout << page_mode_name(mode) << " -> " << page_mode_name(pages.obtained()) << "\n";
+    }
+    std::cout << "page_source test passed\n";
+}
+
+// Test 5.14: Allocation Statistics
+TEST(test_arena_stats) {
+    std::cout << "\n=== Test 5.14: Allocation Statistics ===\n";
+    // Without a stats policy the arena is exactly as large as before
+    static_assert(sizeof(bump<64>) == 64 + 2 * sizeof(size_t), "no_stats must be free");
+
+    bump<64, bump_growth::fixed, arena_stats> a;
+    a.alloc<char>(3);
+    unsigned char_line = __LINE__ - 1;
+    a.alloc<double>();                  // 5 bytes of padding
+    unsigned double_line = __LINE__ - 1;
+    ASSERT(a.alloc<char>(100) == nullptr);
+    unsigned failed_line = __LINE__ - 1;
+
+    const arena_stats& stats = a.stats();
+    ASSERT(stats.allocations() == 2);
+    ASSERT(stats.bytes() == 3 + sizeof(double));
+    ASSERT(stats.padding_bytes() == 5);
+    ASSERT(stats.peak_bytes() == 16);
+    ASSERT(stats.failures() == 1);
+    ASSERT(stats.site(__FILE__, char_line).bytes == 3);
+    ASSERT(stats.site(__FILE__, double_line).padding == 5);
+    ASSERT(stats.site(__FILE__, failed_line).failures == 1);
+
+    // Peak survives resets and rewinds
+    bump_marker m = a.mark();
+    a.alloc<char>(40);
+    a.rewind(m);
+    a.reset();
+    ASSERT(stats.peak_bytes() == 56);
+    ASSERT(stats.resets() == 1 && stats.rewinds() == 1);
+
+    // In a chained arena the spare chunk left by a rewind holds nothing
+    bump<64, bump_growth::chained, arena_stats> chained;
+    chained.alloc<char>(48);
+    bump_marker before_chunk = chained.mark();
+    chained.alloc<char>(100);           // Second chunk, 128 bytes
+    ASSERT(chained.stats().peak_bytes() == 64 + 100);
+    chained.rewind(before_chunk);
+    ASSERT(chained.get_reserved() == 64 + 128);
+    chained.alloc<uint64_t>();
+    ASSERT(chained.stats().peak_bytes() == 64 + 100);
+
+    std::ostringstream report;
+    stats.report(report);
+    ASSERT(report.str().find("peak in use: 56 bytes") != std::string::npos);
+    std::cout << report.str();
+    std::cout << "Allocation statistics test passed\n";
+}
+
+// Test 5.15: Concurrent Bump Allocation
+TEST(test_concurrent_bump) {
+    std::cout << "\n=== Test 5.15: Concurrent Bump ===\n";
+    using arena_type = concurrent_bump<4 * 1024 * 1024>;
+    std::unique_ptr<arena_type> a(new arena_type);
+    constexpr int threads = 4;
+    constexpr int count = 5000;
+    std::vector<std::vector<uint32_t*>> blocks(threads);
+
+    // Half the threads hit the shared offset directly, half carve local blocks.
+    // Every block is stamped with its owner, so any overlap shows up below.
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            arena_type::local_block local(*a, 4096);
+            for (int i = 0; i < count; i++) {
+                uint32_t* p = t % 2 == 0 ? a->alloc<uint32_t>(4) : local.alloc<uint32_t>(4);
+                ASSERT(p != nullptr);
+                ASSERT(reinterpret_cast<uintptr_t>(p) % alignof(uint32_t) == 0);
+                for (int j = 0; j < 4; j++) p[j] = static_cast<uint32_t>(t);
+                blocks[t].push_back(p);
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    for (int t = 0; t < threads; t++) {
+        for (uint32_t* p : blocks[t]) {
+            ASSERT(p[0] == static_cast<uint32_t>(t) && p[3] == static_cast<uint32_t>(t));
+        }
+    }
+
+    // Over-aligned requests, and failure once full
+    void* wide = a->allocate(8, 256);
+    ASSERT(reinterpret_cast<uintptr_t>(wide) % 256 == 0);
+    ASSERT(a->allocate(a->capacity()) == nullptr);
+
+    // After a reset a local block drops its stale block instead of reusing it
+    arena_type::local_block local(*a, 1024);
+    char* before = local.alloc<char>(16);
+    uint64_t epoch = a->epoch();
+    a->reset();
+    ASSERT(a->epoch() == epoch + 1 && a->get_used() == 0);
+    char* shared = a->alloc<char>(16);
+    char* after = local.alloc<char>(16);
+    ASSERT(after != before + 16);
+    ASSERT(after >= shared + 16 || after + 16 <= shared);
+
+    std::cout << "Concurrent bump test passed\n";
+}
+
 // Test 6.1: Benchmark Bump-Up vs Bump-Down
 void benchmark_allocations() {
     std::cout << "\n=== Test 6.1: Benchmark Allocations ===\n";
@@ -125,6 +608,18 @@ int main() {
     test_basic_allocation();
     test_over_allocation();
     test_dealloc_reset();
+    test_chained_growth();
+    test_chained_reset();
+    test_scoped_rewind();
+    test_chained_rewind();
+    test_std_allocator();
+    test_pmr_resource();
+    test_slab_classes();
+    test_slab_threads();
+    test_double_ended();
+    test_page_source();
+    test_arena_stats();
+    test_concurrent_bump();
     benchmark_allocations();
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// A burst of short fibers queued on one scheduler before any of them runs.
+// Lazy is the scheduler as it is: queued fibers are descriptors and a stack
+// is attached at first dispatch. Eager emulates the earlier fibers, which
+// allocated their 64KB stack and wrote its first frame at construction.
+// Each mode runs in its own process so resident memory starts clean.
+//
+// Reports resident bytes per queued fiber, spawn and run time, and the
+// spawn-to-first-run latency of each fiber (dominated by its place in the
+// queue).
+//
+// usage: bench_backlog [fibers] (default 1000000). Eager runs only a tenth
+// of that, since it keeps a touched stack page per queued fiber, next to
+// lazy at the same size.
+
+using clock_type = std::chrono::steady_clock;
+
+// Resident and peak resident bytes, from /proc/self/status
+size_t status_kb(const char* field) {
+    FILE* status = fopen("/proc/self/status", "r");
+    char line[256];
+    size_t kb = 0;
+    while (status != nullptr && fgets(line, sizeof(line), status) != nullptr) {
+        if (strncmp(line, field, strlen(field)) == 0) {
+            kb = strtoull(line + strlen(field), nullptr, 10);
+        }
+    }
+    if (status != nullptr) {
+        fclose(status);
+    }
+    return kb;
+}
+
+// Never entered: eager only needs the first frame written like a real fiber
+void fiber_exit_stub(void*) {}
+
+double percentile(std::vector<float>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void run(const char* mode, size_t count, bool eager) {
+    std::vector<float> latency_us(count);
+    scheduler s;
+    s.stop();
+
+    size_t rss_before = status_kb("VmRSS:");
+    auto spawn_start = clock_type::now();
+    for (size_t i = 0; i < count; i++) {
+        char* stack = nullptr;
+        if (eager) {
+            stack = new char[fiber::default_stack_size];
+            make_stack_context(stack + fiber::default_stack_size, &fiber_exit_stub, nullptr);
+        }
+        s.spawn([&latency_us, i, stack, queued = clock_type::now()] {
+            latency_us[i] = std::chrono::duration<float, std::micro>(clock_type::now() - queued).count();
+            delete[] stack;
+        });
+    }
+    auto spawn_end = clock_type::now();
+    size_t rss_queued = status_kb("VmRSS:");
+    s.run();
+    auto run_end = clock_type::now();
+
+    std::sort(latency_us.begin(), latency_us.end());
+    double per_fiber = (rss_queued - rss_before) * 1024.0 / static_cast<double>(count);
+    std::cout << mode << " (" << count << " fibers)\n"
+              << "  resident per queued fiber: " << static_cast<size_t>(per_fiber) << " B\n"
+              << "  peak resident:             " << status_kb("VmHWM:") / 1024 << " MB\n"
+              << "  spawn:                     "
+              << std::chrono::duration<double, std::nano>(spawn_end - spawn_start).count() / count
+              << " ns/fiber\n"
+              << "  run:                       "
+              << std::chrono::duration<double, std::nano>(run_end - spawn_end).count() / count
+              << " ns/fiber\n"
+              << "  spawn-to-run latency:      p50 " << percentile(latency_us, 0.5) / 1000
+              << " ms, p99 " << percentile(latency_us, 0.99) / 1000
+              << " ms, max " << latency_us.back() / 1000 << " ms\n";
+}
+
+template<typename F>
+void in_child(F f) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        f();
+        std::cout.flush();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::cout << "Backlog of queued fibers, all spawned before the first runs\n";
+    in_child([count] { run("eager stacks", count / 10, true); });
+    in_child([count] { run("lazy stacks", count / 10, false); });
+    in_child([count] { run("lazy stacks", count, false); });
+    return 0;
+}
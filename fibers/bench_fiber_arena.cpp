@@ -0,0 +1,81 @@
+#include "fiber_pool.hpp"
+#include "wait_group.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Request-handler workload: every request is a fiber that builds a few dozen
+// scratch buffers, yields once (as if waiting on I/O) and finishes. With the
+// arena on, scratch comes from current_arena() and is released in one step at
+// fiber exit; with it off, every buffer is a malloc/free pair.
+
+constexpr size_t requests = 50000;
+constexpr size_t in_flight = 1000;     // Requests admitted per wave
+constexpr size_t buffers = 48;
+
+volatile size_t sink = 0;
+
+size_t buffer_size(size_t i) {
+    return 32 + (i * 53) % 480;
+}
+
+void handler_with_arena(wait_group& done) {
+    fiber_arena& a = current_arena();
+    size_t total = 0;
+    char* first = nullptr;
+    for (size_t i = 0; i < buffers; i++) {
+        char* b = a.alloc<char>(buffer_size(i));
+        std::memset(b, static_cast<int>(i), 16);
+        if (first == nullptr) first = b;
+        total += static_cast<unsigned char>(b[0]);
+    }
+    scheduler::current()->yield();
+    sink = sink + total + first[0];
+    done.done();
+}
+
+void handler_with_malloc(wait_group& done) {
+    char* blocks[buffers];
+    size_t total = 0;
+    for (size_t i = 0; i < buffers; i++) {
+        blocks[i] = static_cast<char*>(std::malloc(buffer_size(i)));
+        std::memset(blocks[i], static_cast<int>(i), 16);
+        total += static_cast<unsigned char>(blocks[i][0]);
+    }
+    scheduler::current()->yield();
+    sink = sink + total + blocks[0][0];
+    for (size_t i = 0; i < buffers; i++) {
+        std::free(blocks[i]);
+    }
+    done.done();
+}
+
+template<typename Handler>
+long long run(size_t threads, Handler handler) {
+    fiber_pool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < requests; r += in_flight) {
+        wait_group done(in_flight);
+        for (size_t i = 0; i < in_flight; i++) {
+            pool.post(handler, std::ref(done));
+        }
+        done.wait();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Request handlers (" << requests << " fibers, " << buffers
+              << " scratch buffers each)\n";
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        long long arena_us = run(threads, handler_with_arena);
+        long long malloc_us = run(threads, handler_with_malloc);
+        std::cout << "threads=" << threads << ": arena on " << arena_us
+                  << " µs, arena off (malloc) " << malloc_us << " µs\n";
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Cross-thread spawn throughput: P producer threads post fibers into one
+// scheduler's inbox while the scheduler thread drains and runs them.
+
+std::atomic<size_t> completed{0};
+
+void bench_fiber() {
+    completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void benchmark_cross_thread_spawn(size_t producers, size_t total) {
+    size_t per_producer = total / producers;
+    size_t count = per_producer * producers;
+
+    // Fibers are built up front so only the inbox and the run loop are timed
+    std::vector<fiber*> fibers;
+    fibers.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        fibers.push_back(new fiber(bench_fiber, 4096));
+    }
+
+    completed = 0;
+    scheduler s;
+    std::atomic<bool> go{false};
+
+    std::thread consumer([&s] { s.run(); });
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < per_producer; i++) {
+                s.post(fibers[p * per_producer + i]);
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    s.stop();
+    consumer.join();
+    auto end = std::chrono::steady_clock::now();
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << producers << " producer(s): " << count << " spawns in "
+              << ns / 1000 << " µs, "
+              << (ns > 0 ? count * 1000000000.0 / ns / 1e6 : 0.0) << " M spawns/s"
+              << (completed.load() == count ? "" : " [MISSING FIBERS]")
+              << std::endl;
+
+    for (fiber* f : fibers) {
+        delete f;
+    }
+}
+
+int main() {
+    constexpr size_t total = 32768;
+    std::cout << "Cross-thread spawn throughput (" << total << " fibers)\n";
+    for (size_t producers = 1; producers <= 16; producers *= 2) {
+        benchmark_cross_thread_spawn(producers, total);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Scaling of the fork-join kernels (sum, map, sort-merge) against a serial
+// baseline and hand-partitioned std::thread versions.
+
+template<typename Func>
+long long time_us(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Split [0, n) into `threads` contiguous chunks, one std::thread each;
+// body(chunk, begin, end)
+template<typename Body>
+void std_thread_for(size_t threads, size_t n, Body body) {
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++) {
+        size_t begin = n * t / threads;
+        size_t end = n * (t + 1) / threads;
+        pool.emplace_back([&body, t, begin, end] { body(t, begin, end); });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+volatile double sink = 0;
+
+void fiber_sort(fiber_pool& pool, double* first, double* last) {
+    if (last - first <= 4096) {
+        std::sort(first, last);
+        return;
+    }
+    double* mid = first + (last - first) / 2;
+    parallel_invoke(pool,
+        [&pool, first, mid] { fiber_sort(pool, first, mid); },
+        [&pool, mid, last] { fiber_sort(pool, mid, last); });
+    std::inplace_merge(first, mid, last);
+}
+
+void thread_sort(size_t threads, std::vector<double>& data) {
+    size_t n = data.size();
+    std_thread_for(threads, n, [&data](size_t, size_t begin, size_t end) {
+        std::sort(data.begin() + begin, data.begin() + end);
+    });
+    // Merge neighbouring chunks pairwise, one thread per merge
+    for (size_t width = 1; width < threads; width *= 2) {
+        std::vector<std::thread> merges;
+        for (size_t t = 0; t + width < threads; t += 2 * width) {
+            size_t begin = n * t / threads;
+            size_t mid = n * (t + width) / threads;
+            size_t end = n * std::min(t + 2 * width, threads) / threads;
+            merges.emplace_back([&data, begin, mid, end] {
+                std::inplace_merge(data.begin() + begin, data.begin() + mid,
+                                   data.begin() + end);
+            });
+        }
+        for (auto& th : merges) {
+            th.join();
+        }
+    }
+}
+
+std::vector<double> make_input(size_t n) {
+    std::vector<double> data(n);
+    for (size_t i = 0; i < n; i++) {
+        data[i] = static_cast<double>((i * 2654435761u) % 1000003);
+    }
+    return data;
+}
+
+void report(const char* kernel, const char* variant, size_t threads, long long us,
+            long long serial_us) {
+    std::cout << kernel << " " << variant << " threads=" << threads << ": "
+              << us << " µs (speedup " << (us > 0 ? double(serial_us) / us : 0.0)
+              << "x)" << std::endl;
+}
+
+int main() {
+    constexpr size_t n = 1 << 22;
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<double> input = make_input(n);
+    std::vector<double> output(n);
+
+    // Serial baselines
+    long long sum_serial = time_us([&] {
+        double acc = 0;
+        for (double v : input) acc += v;
+        sink = acc;
+    });
+    long long map_serial = time_us([&] {
+        for (size_t i = 0; i < n; i++) output[i] = std::sqrt(input[i]) * 1.5;
+    });
+    std::vector<double> to_sort = input;
+    long long sort_serial = time_us([&] { std::sort(to_sort.begin(), to_sort.end()); });
+
+    std::cout << "Fork-join kernels over " << n << " doubles\n";
+    std::cout << "sum serial: " << sum_serial << " µs\n";
+    std::cout << "map serial: " << map_serial << " µs\n";
+    std::cout << "sort serial: " << sort_serial << " µs\n";
+
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    for (size_t threads : thread_counts) {
+        fiber_pool pool(threads);
+
+        long long us = time_us([&] {
+            sink = parallel_reduce(pool, 0, n, 0, 0.0,
+                [&input](size_t i) { return input[i]; },
+                [](double a, double b) { return a + b; });
+        });
+        report("sum", "fibers", threads, us, sum_serial);
+
+        us = time_us([&] {
+            std::vector<double> partial(threads);
+            std_thread_for(threads, n, [&](size_t t, size_t begin, size_t end) {
+                double acc = 0;
+                for (size_t i = begin; i < end; i++) acc += input[i];
+                partial[t] = acc;
+            });
+            double acc = 0;
+            for (double p : partial) acc += p;
+            sink = acc;
+        });
+        report("sum", "std::thread", threads, us, sum_serial);
+
+        us = time_us([&] {
+            parallel_for(pool, 0, n, 0, [&](size_t i) {
+                output[i] = std::sqrt(input[i]) * 1.5;
+            });
+        });
+        report("map", "fibers", threads, us, map_serial);
+
+        us = time_us([&] {
+            std_thread_for(threads, n, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) output[i] = std::sqrt(input[i]) * 1.5;
+            });
+        });
+        report("map", "std::thread", threads, us, map_serial);
+
+        to_sort = input;
+        us = time_us([&] { fiber_sort(pool, to_sort.data(), to_sort.data() + n); });
+        report("sort", "fibers", threads, us, sort_serial);
+
+        to_sort = input;
+        us = time_us([&] { thread_sort(threads, to_sort); });
+        report("sort", "std::thread", threads, us, sort_serial);
+    }
+    return 0;
+}
@@ -0,0 +1,399 @@
+#include "channel.hpp"
+#include "fiber_pool.hpp"
+#include "wait_group.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Scheduler workloads on a fiber_pool:
+//
+//   skynet     1M leaf fibers in a 10-ary tree, each level summing its
+//              children through a wait_group           (op: fiber, latency: run)
+//   ring       a token passed around N fibers linked by channels
+//                                                      (op: hop, latency: hop)
+//   fan_out    a fiber forks a batch of children and joins them, repeatedly
+//                                                      (op: fiber, latency: batch)
+//   yield      many fibers yielding in a loop          (op: yield, latency: yield
+//                                                       until resumed)
+//   ping_pong  pairs of fibers exchanging messages over two channels
+//                                                      (op: round trip, latency:
+//                                                       round trip)
+//
+// Each workload runs --reps times on a fresh pool. Throughput is ops per
+// second of the median repetition; latency percentiles are over every sample
+// of every repetition. Peak RSS is the high-water mark during the workload
+// (reset between workloads by trimming the heap and writing
+// /proc/self/clear_refs). Context switches are scheduler dispatches, each a
+// switch into a fiber and back.
+//
+// usage: bench_scheduler [--threads N] [--reps N] [--scale F] [--json FILE]
+//        --scale multiplies every workload size (0.1 for a quick run)
+
+using clock_type = std::chrono::steady_clock;
+
+struct options {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t reps = 3;
+    double scale = 1.0;
+    std::string json_path;
+};
+
+struct result {
+    std::string name;
+    std::string op;
+    std::string latency_of;
+    size_t ops = 0;                 // Per repetition
+    double seconds = 0;             // Median repetition
+    double p50_ns = 0, p90_ns = 0, p99_ns = 0, max_ns = 0;
+    size_t peak_rss_kb = 0;
+    double switches_per_sec = 0;
+
+    double throughput() const { return seconds > 0 ? ops / seconds : 0; }
+};
+
+// Latency samples of one fiber; merged after the run
+using samples = std::vector<float>;
+
+float ns_since(clock_type::time_point start) {
+    return std::chrono::duration<float, std::nano>(clock_type::now() - start).count();
+}
+
+size_t status_kb(const char* field) {
+    FILE* status = fopen("/proc/self/status", "r");
+    char line[256];
+    size_t kb = 0;
+    while (status != nullptr && fgets(line, sizeof(line), status) != nullptr) {
+        if (strncmp(line, field, strlen(field)) == 0) {
+            kb = strtoull(line + strlen(field), nullptr, 10);
+        }
+    }
+    if (status != nullptr) {
+        fclose(status);
+    }
+    return kb;
+}
+
+// Hand freed heap back to the OS, then lower the peak RSS mark to the
+// current RSS (Linux 4.0+)
+void reset_peak_rss() {
+    malloc_trim(0);
+    if (FILE* f = fopen("/proc/self/clear_refs", "w")) {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+// Runs body(pool, latencies) reps times; body runs on a plain thread, posts
+// its fibers to the pool and returns once they are all done
+template<typename Body>
+result measure(const std::string& name, const std::string& op, const std::string& latency_of,
+               size_t ops, const options& opts, Body body) {
+    result r;
+    r.name = name;
+    r.op = op;
+    r.latency_of = latency_of;
+    r.ops = ops;
+    reset_peak_rss();
+
+    std::vector<double> times;
+    samples all;
+    size_t dispatches = 0;
+    double total_seconds = 0;
+    for (size_t rep = 0; rep < opts.reps; rep++) {
+        std::vector<samples> latencies;
+        auto pool = std::make_unique<fiber_pool>(opts.threads);
+        auto start = clock_type::now();
+        body(*pool, latencies);
+        double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        for (size_t w = 0; w < pool->size(); w++) {
+            dispatches += pool->worker(w).dispatches();
+        }
+        pool.reset();
+        times.push_back(seconds);
+        total_seconds += seconds;
+        for (const samples& s : latencies) {
+            all.insert(all.end(), s.begin(), s.end());
+        }
+    }
+    std::sort(times.begin(), times.end());
+    r.seconds = times[times.size() / 2];
+    r.switches_per_sec = dispatches / total_seconds;
+    r.peak_rss_kb = status_kb("VmHWM:");
+
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) -> double {
+        if (all.empty()) {
+            return 0;
+        }
+        size_t rank = static_cast<size_t>(p * static_cast<double>(all.size()));
+        return all[std::min(rank, all.size() - 1)];
+    };
+    r.p50_ns = percentile(0.5);
+    r.p90_ns = percentile(0.9);
+    r.p99_ns = percentile(0.99);
+    r.max_ns = all.empty() ? 0 : all.back();
+    return r;
+}
+
+// Run root on the pool and block the calling thread until it returns
+template<typename Root>
+void run_on(fiber_pool& pool, Root root) {
+    wait_group done(1);
+    pool.post([&root, &done] {
+        root();
+        done.done();
+    });
+    done.wait();
+}
+
+// ---------------------------------------------------------------------------
+// Workloads
+
+void skynet(fiber_pool& pool, uint64_t num, uint64_t size, uint64_t& sum) {
+    if (size == 1) {
+        sum = num;
+        return;
+    }
+    uint64_t sums[10];
+    wait_group children(10);
+    for (uint64_t i = 0; i < 10; i++) {
+        pool.post([&pool, &sums, &children, i, num, size] {
+            skynet(pool, num + i * (size / 10), size / 10, sums[i]);
+            children.done();
+        });
+    }
+    children.wait();
+    sum = 0;
+    for (uint64_t s : sums) {
+        sum += s;
+    }
+}
+
+result run_skynet(const options& opts) {
+    // Whole levels only: 10^k leaves
+    uint64_t leaves = 1;
+    while (leaves * 10 <= static_cast<uint64_t>(1000000 * opts.scale)) {
+        leaves *= 10;
+    }
+    uint64_t fibers = (leaves * 10 - 1) / 9;
+    return measure("skynet", "fiber", "run", fibers, opts,
+                   [leaves](fiber_pool& pool, std::vector<samples>& latencies) {
+        uint64_t sum = 0;
+        auto start = clock_type::now();
+        run_on(pool, [&] { skynet(pool, 0, leaves, sum); });
+        latencies.push_back({ns_since(start)});
+        if (sum != leaves * (leaves - 1) / 2) {
+            std::cerr << "skynet: wrong sum " << sum << "\n";
+            exit(1);
+        }
+    });
+}
+
+struct token {
+    size_t hops;
+    clock_type::time_point sent;
+};
+
+result run_ring(const options& opts) {
+    size_t fibers = 1000;
+    size_t hops = static_cast<size_t>(1000000 * opts.scale);
+    return measure("ring", "hop", "hop", hops, opts,
+                   [fibers, hops](fiber_pool& pool, std::vector<samples>& latencies) {
+        std::vector<std::unique_ptr<channel<token>>> links;
+        for (size_t i = 0; i < fibers; i++) {
+            links.push_back(std::make_unique<channel<token>>(1));
+        }
+        latencies.resize(fibers);
+        wait_group done(static_cast<uint32_t>(fibers));
+        for (size_t i = 0; i < fibers; i++) {
+            pool.post([&, i] {
+                channel<token>& in = *links[i];
+                channel<token>& out = *links[(i + 1) % fibers];
+                while (std::optional<token> t = in.receive()) {
+                    latencies[i].push_back(ns_since(t->sent));
+                    if (t->hops == 0) {
+                        break;
+                    }
+                    out.send({t->hops - 1, clock_type::now()});
+                }
+                out.close();    // Passes the end on around the ring
+                done.done();
+            });
+        }
+        run_on(pool, [&] { links[0]->send({hops, clock_type::now()}); });
+        done.wait();
+    });
+}
+
+result run_fan_out(const options& opts) {
+    size_t width = 1000;
+    size_t batches = std::max<size_t>(1, static_cast<size_t>(1000 * opts.scale));
+    return measure("fan_out", "fiber", "batch", width * batches, opts,
+                   [width, batches](fiber_pool& pool, std::vector<samples>& latencies) {
+        latencies.resize(1);
+        run_on(pool, [&] {
+            std::vector<uint64_t> results(width);
+            for (size_t b = 0; b < batches; b++) {
+                auto start = clock_type::now();
+                wait_group children(static_cast<uint32_t>(width));
+                for (size_t i = 0; i < width; i++) {
+                    pool.post([&results, &children, i, b] {
+                        results[i] = i * b;
+                        children.done();
+                    });
+                }
+                children.wait();
+                latencies[0].push_back(ns_since(start));
+            }
+        });
+    });
+}
+
+result run_yield(const options& opts) {
+    size_t fibers = 1000;
+    size_t yields = std::max<size_t>(1, static_cast<size_t>(1000 * opts.scale));
+    return measure("yield", "yield", "yield until resumed", fibers * yields, opts,
+                   [fibers, yields](fiber_pool& pool, std::vector<samples>& latencies) {
+        latencies.resize(fibers);
+        wait_group done(static_cast<uint32_t>(fibers));
+        for (size_t i = 0; i < fibers; i++) {
+            latencies[i].reserve(yields);
+            pool.post([&latencies, &done, i, yields] {
+                for (size_t y = 0; y < yields; y++) {
+                    auto start = clock_type::now();
+                    scheduler::current()->yield();
+                    latencies[i].push_back(ns_since(start));
+                }
+                done.done();
+            });
+        }
+        done.wait();
+    });
+}
+
+result run_ping_pong(const options& opts) {
+    size_t pairs = opts.threads;
+    size_t rounds = static_cast<size_t>(1000000 * opts.scale) / pairs;
+    return measure("ping_pong", "round trip", "round trip", pairs * rounds, opts,
+                   [pairs, rounds](fiber_pool& pool, std::vector<samples>& latencies) {
+        std::vector<std::unique_ptr<channel<size_t>>> ping, pong;
+        for (size_t p = 0; p < pairs; p++) {
+            ping.push_back(std::make_unique<channel<size_t>>(1));
+            pong.push_back(std::make_unique<channel<size_t>>(1));
+        }
+        latencies.resize(pairs);
+        wait_group done(static_cast<uint32_t>(2 * pairs));
+        for (size_t p = 0; p < pairs; p++) {
+            latencies[p].reserve(rounds);
+            // The two sides on neighbouring workers, so they cross threads
+            // whenever there is more than one
+            pool.worker(p % pool.size()).post([&, p] {
+                for (size_t r = 0; r < rounds; r++) {
+                    auto start = clock_type::now();
+                    ping[p]->send(r);
+                    pong[p]->receive();
+                    latencies[p].push_back(ns_since(start));
+                }
+                done.done();
+            });
+            pool.worker((p + 1) % pool.size()).post([&, p] {
+                for (size_t r = 0; r < rounds; r++) {
+                    pong[p]->send(*ping[p]->receive());
+                }
+                done.done();
+            });
+        }
+        done.wait();
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Reporting
+
+void print(const result& r) {
+    std::cout << std::left << std::setw(11) << r.name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << r.throughput() / 1e6
+              << std::setw(11) << r.p50_ns / 1000 << std::setw(11) << r.p99_ns / 1000
+              << std::setw(12) << r.max_ns / 1000 << std::setw(10) << r.peak_rss_kb / 1024
+              << std::setw(12) << r.switches_per_sec / 1e6 << "   " << r.op << "s, "
+              << r.latency_of << "\n";
+}
+
+void write_json(std::ostream& out, const options& opts, const std::vector<result>& results) {
+    out << "{\n  \"threads\": " << opts.threads << ",\n  \"reps\": " << opts.reps
+        << ",\n  \"scale\": " << opts.scale << ",\n  \"workloads\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"op\": \"" << r.op
+            << "\", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << r.throughput()
+            << ", \"latency_of\": \"" << r.latency_of << "\""
+            << ", \"p50_ns\": " << r.p50_ns << ", \"p90_ns\": " << r.p90_ns
+            << ", \"p99_ns\": " << r.p99_ns << ", \"max_ns\": " << r.max_ns
+            << ", \"peak_rss_kb\": " << r.peak_rss_kb
+            << ", \"switches_per_sec\": " << r.switches_per_sec << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int usage(const char* program) {
+    std::cerr << "usage: " << program << " [--threads N] [--reps N] [--scale F] [--json FILE]\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "missing value for " << flag << "\n";
+            return usage(argv[0]);
+        }
+        if (flag == "--threads") {
+            opts.threads = std::max(1ul, std::stoul(argv[i + 1]));
+        } else if (flag == "--reps") {
+            opts.reps = std::max(1ul, std::stoul(argv[i + 1]));
+        } else if (flag == "--scale") {
+            opts.scale = std::stod(argv[i + 1]);
+        } else if (flag == "--json") {
+            opts.json_path = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << flag << "\n";
+            return usage(argv[0]);
+        }
+    }
+
+    std::cout << "Scheduler workloads (" << opts.threads << " threads, " << opts.reps
+              << " reps, scale " << opts.scale << ")\n\n";
+    std::cout << std::left << std::setw(11) << "workload" << std::right << std::setw(12)
+              << "Mops/s" << std::setw(11) << "p50 us" << std::setw(11) << "p99 us"
+              << std::setw(12) << "max us" << std::setw(10) << "peak MB" << std::setw(12)
+              << "Mswitch/s" << "\n";
+
+    std::vector<result> results;
+    for (auto workload : {run_skynet, run_ring, run_fan_out, run_yield, run_ping_pong}) {
+        results.push_back(workload(opts));
+        print(results.back());
+    }
+
+    if (!opts.json_path.empty()) {
+        std::ofstream out(opts.json_path);
+        write_json(out, opts, results);
+        if (!out) {
+            std::cerr << "could not write " << opts.json_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
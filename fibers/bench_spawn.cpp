@@ -0,0 +1,79 @@
+#include "scheduler.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+// Spawn cost for lambdas with 0, 32 and 128 bytes of captures. The task
+// rows isolate the callable storage (inline buffer vs heap fallback) against
+// std::function; the spawn rows include the fiber, its stack and running it.
+
+template<size_t Bytes>
+struct payload {
+    char bytes[Bytes];
+};
+
+template<>
+struct payload<0> {};
+
+volatile size_t sink = 0;
+
+template<size_t Bytes>
+auto make_lambda() {
+    payload<Bytes> p{};
+    return [p]() { sink = sink + sizeof(p); };
+}
+
+template<typename Func>
+long long time_ns(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+template<size_t Bytes>
+void benchmark_captures(size_t count) {
+    using lambda = decltype(make_lambda<Bytes>());
+
+    auto task_ns = time_ns([count] {
+        for (size_t i = 0; i < count; i++) {
+            task t(make_lambda<Bytes>());
+            t();
+        }
+    });
+
+    auto function_ns = time_ns([count] {
+        for (size_t i = 0; i < count; i++) {
+            std::function<void()> f(make_lambda<Bytes>());
+            f();
+        }
+    });
+
+    auto spawn_ns = time_ns([count] {
+        // Run in batches so finished fibers hand their stacks back to malloc
+        constexpr size_t batch = 1000;
+        scheduler s;
+        s.stop();
+        for (size_t i = 0; i < count; i += batch) {
+            for (size_t j = 0; j < batch; j++) {
+                s.spawn(make_lambda<Bytes>());
+            }
+            s.run();
+        }
+    });
+
+    std::cout << Bytes << "-byte capture ("
+              << (task::stored_inline<lambda>() ? "inline" : "heap") << "):\n"
+              << "  task:          " << task_ns / double(count) << " ns/op\n"
+              << "  std::function: " << function_ns / double(count) << " ns/op\n"
+              << "  spawn + run:   " << spawn_ns / double(count) << " ns/op\n";
+}
+
+int main() {
+    constexpr size_t count = 100000;
+    std::cout << "Spawn cost by capture size (" << count << " iterations)\n";
+    benchmark_captures<0>(count);
+    benchmark_captures<32>(count);
+    benchmark_captures<128>(count);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "scheduler.hpp"
+#include "static_scheduler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The same fixed task set on static_scheduler and on the dynamic scheduler:
+// eight fibers on one thread, each adding to its own counter and yielding
+// a given number of times. Two sizes are measured:
+//
+//   lifecycle  no yields: start every fiber, run it once, finish (ns/fiber)
+//   switch     many yields: dispatch cost per context switch   (ns/switch)
+//
+// Heap allocations are counted by replacing operator new for the process,
+// and reported per run of the task set. Times are the median of
+// the repetitions.
+//
+// usage: bench_static [yields] [reps] (default 100000 and 9)
+
+using clock_type = std::chrono::steady_clock;
+
+std::atomic<size_t> heap_allocations{0};
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+constexpr size_t task_count = 8;
+size_t yields = 0;
+size_t counters[task_count];
+
+template<void (*Yield)(), size_t I>
+void task() {
+    for (size_t y = 0; y < yields; y++) {
+        counters[I] += I + 1;
+        Yield();
+    }
+    counters[I] += I + 1;
+}
+
+void static_yield();
+void dynamic_yield() { scheduler::current()->yield(); }
+
+template<size_t... I>
+auto make_static_set(std::index_sequence<I...>)
+    -> static_scheduler<static_fiber<&task<static_yield, I>, 8192>...>;
+
+using static_set = decltype(make_static_set(std::make_index_sequence<task_count>()));
+
+void static_yield() { static_set::yield(); }
+
+void run_static() {
+    static_set::run();
+}
+
+template<size_t... I>
+void run_dynamic(std::index_sequence<I...>) {
+    scheduler s;
+    (s.spawn(&task<dynamic_yield, I>), ...);
+    s.stop();
+    s.run();
+}
+
+void run_dynamic() {
+    run_dynamic(std::make_index_sequence<task_count>());
+}
+
+struct measurement {
+    double ns;              // Median per run
+    size_t allocations;     // Per run
+};
+
+measurement measure(void (*run)(), size_t reps) {
+    std::vector<double> times;
+    times.reserve(reps);
+    size_t allocations = 0;
+    for (size_t r = 0; r < reps; r++) {
+        std::fill(std::begin(counters), std::end(counters), 0);
+        size_t before = heap_allocations.load(std::memory_order_relaxed);
+        auto start = clock_type::now();
+        run();
+        auto end = clock_type::now();
+        allocations = heap_allocations.load(std::memory_order_relaxed) - before;
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        for (size_t i = 0; i < task_count; i++) {
+            if (counters[i] != (yields + 1) * (i + 1)) {
+                std::cerr << "task " << i << " ran " << counters[i] / (i + 1) << " steps\n";
+                std::exit(1);
+            }
+        }
+    }
+    std::sort(times.begin(), times.end());
+    return {times[times.size() / 2], allocations};
+}
+
+void report(const std::string& name, size_t per_run, const char* unit, size_t reps) {
+    measurement dynamic = measure(&run_dynamic, reps);
+    measurement fixed = measure(&run_static, reps);
+    auto row = [&](const char* mode, const measurement& m) {
+        std::cout << "  " << mode << m.ns / static_cast<double>(per_run) << " ns/" << unit
+                  << ", " << m.allocations << " heap allocations per run\n";
+    };
+    std::cout << name << "\n";
+    row("dynamic scheduler: ", dynamic);
+    row("static_scheduler:  ", fixed);
+    std::cout << "  speedup:           " << dynamic.ns / fixed.ns << "x\n";
+}
+
+int main(int argc, char** argv) {
+    size_t many = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t reps = argc > 2 ? std::stoul(argv[2]) : 9;
+    std::cout << task_count << " fibers on one thread, static stacks: "
+              << static_set::stack_bytes() / 1024 << " KB\n";
+
+    yields = 0;
+    report("lifecycle (start, run once, finish)", task_count, "fiber", reps * 100);
+
+    yields = many;
+    report("switch (" + std::to_string(many) + " yields per fiber)", task_count * (many + 1),
+           "switch", reps);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef FIBERS_CHANNEL_HPP
+#define FIBERS_CHANNEL_HPP
+
+#include "scheduler.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+// Bounded channel between fibers, on any mix of schedulers.
+//
+// send() suspends the calling fiber while the buffer is full and receive()
+// while it is empty. A fiber that blocks is put on a waiter list and posted
+// back to its own scheduler by the operation that unblocks it, then checks
+// again. The lock is only held for the buffer and list updates, never while
+// suspended. Both may only be called from a fiber. close() wakes every
+// blocked fiber: senders give up, receivers drain what is buffered.
+template<typename T>
+class channel {
+private:
+    struct waiter {
+        fiber* f;
+        scheduler* s;
+    };
+
+    std::mutex lock_;
+    std::deque<T> items_;
+    size_t capacity_;
+    std::deque<waiter> senders_;    // Blocked on a full buffer
+    std::deque<waiter> receivers_;  // Blocked on an empty buffer
+    bool closed_ = false;
+
+public:
+    explicit channel(size_t capacity = 1) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    // False, with value dropped, if the channel is or gets closed first
+    bool send(T value) {
+        std::unique_lock<std::mutex> hold(lock_);
+        while (!closed_ && items_.size() == capacity_) {
+            block(senders_, hold);
+        }
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(value));
+        wake_one(receivers_, hold);
+        return true;
+    }
+
+    // The next item, or nullopt once the channel is closed and drained
+    std::optional<T> receive() {
+        std::unique_lock<std::mutex> hold(lock_);
+        while (items_.empty()) {
+            if (closed_) {
+                return std::nullopt;
+            }
+            block(receivers_, hold);
+        }
+        T value = std::move(items_.front());
+        items_.pop_front();
+        wake_one(senders_, hold);
+        return value;
+    }
+
+    // Any thread: receivers drain what is buffered, then get nullopt, and
+    // senders get false
+    void close() {
+        std::deque<waiter> woken;
+        {
+            std::lock_guard<std::mutex> hold(lock_);
+            closed_ = true;
+            woken.swap(receivers_);
+            woken.insert(woken.end(), senders_.begin(), senders_.end());
+            senders_.clear();
+        }
+        for (const waiter& w : woken) {
+            resume(w);
+        }
+    }
+
+private:
+    // Park the calling fiber on list; returns with the lock held again
+    void block(std::deque<waiter>& list, std::unique_lock<std::mutex>& hold) {
+        scheduler* s = scheduler::current();
+        list.push_back({s->running(), s});
+        hold.unlock();
+        s->suspend();
+        hold.lock();
+    }
+
+    void wake_one(std::deque<waiter>& list, std::unique_lock<std::mutex>& hold) {
+        if (list.empty()) {
+            return;
+        }
+        waiter w = list.front();
+        list.pop_front();
+        hold.unlock();
+        resume(w);
+    }
+
+    // Straight onto the run queue when the waiter's scheduler is this thread
+    static void resume(const waiter& w) {
+        if (w.s == scheduler::current()) {
+            w.s->spawn(w.f);
+        } else {
+            w.s->post(w.f);
+        }
+    }
+};
+
+#endif // FIBERS_CHANNEL_HPP
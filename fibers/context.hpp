@@ -2,7 +2,9 @@
 #define FIBERS_CONTEXT_HPP
 
 #include <csetjmp>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #ifdef _WIN32
 #define NORETURN __declspec(noreturn)
@@ -22,10 +24,11 @@ struct Context {
     std::jmp_buf env;
 };
 
-// Save current context to ctx and return 0
-inline int get_context(Context* ctx) {
-    return setjmp(ctx->env);
-}
+// Save current context to ctx and return 0. A macro, not a function:
+// setjmp must run in the frame that set_context() later returns into, and
+// compilers never inline a function that calls setjmp, so a wrapper's frame
+// would already be gone by then (this crashed once built with -O2).
+#define get_context(ctx) setjmp((ctx)->env)
 
 // Load context from ctx
 NORETURN inline void set_context(Context* ctx) {
@@ -39,4 +42,93 @@ inline void swap_context(Context* old_ctx, Context* new_ctx) {
     }
 }
 
+// ---------------------------------------------------------------------------
+// Stack switching
+//
+// setjmp/longjmp cannot enter a fresh stack, so fibers use a small x86_64
+// System V switch routine instead. The callee-saved registers (plus MXCSR and
+// the x87 control word) are pushed on the current stack and the resulting
+// stack pointer is the whole saved context.
+//
+// The routines live in a COMDAT section so that every translation unit that
+// includes this header can emit them without duplicate symbol errors.
+// ---------------------------------------------------------------------------
+#if !defined(__x86_64__)
+#error "fibers: stack switching is only implemented for x86_64"
+#endif
+
+extern "C" {
+// Save the current context to *from_sp and resume the context saved at to_sp
+void fibers_switch_stack(void** from_sp, void* to_sp);
+// First frame of every new stack: calls r13(r12)
+void fibers_trampoline();
+}
+
+asm(R"(
+    .pushsection .text.fibers_switch_stack,"axG",@progbits,fibers_switch_stack,comdat
+    .globl fibers_switch_stack
+    .hidden fibers_switch_stack
+    .type fibers_switch_stack,@function
+    .align 16
+fibers_switch_stack:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size fibers_switch_stack, .-fibers_switch_stack
+    .popsection
+
+    .pushsection .text.fibers_trampoline,"axG",@progbits,fibers_trampoline,comdat
+    .globl fibers_trampoline
+    .hidden fibers_trampoline
+    .type fibers_trampoline,@function
+    .align 16
+fibers_trampoline:
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .size fibers_trampoline, .-fibers_trampoline
+    .popsection
+)");
+
+// Prepare a stack so that the first fibers_switch_stack() to the returned
+// stack pointer calls entry(arg). entry must never return.
+inline void* make_stack_context(void* stack_top, void (*entry)(void*), void* arg) {
+    // System V ABI: 16-byte stack alignment, then keep a little headroom
+    uintptr_t top = reinterpret_cast<uintptr_t>(stack_top) & ~uintptr_t(0xF);
+    top -= 16;
+
+    // Frame popped by fibers_switch_stack: csr, r15, r14, r13, r12, rbx, rbp, ret
+    void** frame = reinterpret_cast<void**>(top - 8 * sizeof(void*));
+    uint32_t mxcsr = 0x1F80;   // Default SSE control/status
+    uint16_t fpucw = 0x037F;   // Default x87 control word
+    std::memcpy(reinterpret_cast<char*>(frame), &mxcsr, sizeof(mxcsr));
+    std::memcpy(reinterpret_cast<char*>(frame) + 4, &fpucw, sizeof(fpucw));
+    frame[1] = nullptr;                                        // r15
+    frame[2] = nullptr;                                        // r14
+    frame[3] = reinterpret_cast<void*>(entry);                 // r13
+    frame[4] = arg;                                            // r12
+    frame[5] = nullptr;                                        // rbx
+    frame[6] = nullptr;                                        // rbp
+    frame[7] = reinterpret_cast<void*>(&fibers_trampoline);    // return address
+    return frame;
+}
+
 #endif // FIBERS_CONTEXT_HPP 
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef FIBERS_FIBER_POOL_HPP
+#define FIBERS_FIBER_POOL_HPP
+
+#include "scheduler.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// One scheduler per OS thread. Work is handed out round-robin through each
+// worker's inbox, so any thread (or fiber) may post.
+//
+// Fibers posted through the pool are counted until they finish. The
+// workers are only stopped once the pool is being destroyed and that count
+// is zero, so a fork posted late never lands on a worker that has already
+// gone idle and returned. Fibers posted straight to worker(i) are not
+// counted and must not post to the pool once it is being destroyed.
+class fiber_pool {
+private:
+    std::vector<std::unique_ptr<scheduler>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> outstanding_{0};    // Posted and not yet finished
+    std::atomic<bool> closing_{false};      // In the destructor
+
+public:
+    explicit fiber_pool(size_t threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (size_t i = 0; i < threads; i++) {
+            workers_.push_back(std::make_unique<scheduler>());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            threads_.emplace_back([s = workers_[i].get()] { s->run(); });
+        }
+    }
+
+    // Returns once all posted fibers, and the fibers they forked, have finished
+    ~fiber_pool() {
+        closing_.store(true, std::memory_order_seq_cst);
+        if (outstanding_.load(std::memory_order_seq_cst) == 0) {
+            stop_workers();
+        }
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    fiber_pool(const fiber_pool&) = delete;
+    fiber_pool& operator=(const fiber_pool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    scheduler& worker(size_t index) { return *workers_[index]; }
+
+    // Any thread: run fn(args...) on a new fiber on the next worker
+    template<typename F, typename... Args>
+    void post(F fn, Args... args) {
+        size_t index = next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+        workers_[index]->post([this, fn = std::move(fn),
+                               args = std::make_tuple(std::move(args)...)]() mutable {
+            std::apply(fn, std::move(args));
+            finished();
+        });
+    }
+
+private:
+    // The last counted fiber to finish during destruction stops the workers.
+    // Either it or the destructor sees both conditions; stopping twice is
+    // harmless.
+    void finished() {
+        if (outstanding_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            closing_.load(std::memory_order_seq_cst)) {
+            stop_workers();
+        }
+    }
+
+    void stop_workers() {
+        for (auto& w : workers_) {
+            w->stop();
+        }
+    }
+};
+
+#endif // FIBERS_FIBER_POOL_HPP
@@ -0,0 +1,23 @@
+#ifndef FIBERS_FUTEX_HPP
+#define FIBERS_FUTEX_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Block while *word == expected (may return spuriously)
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// Wake up to count threads blocked in futex_wait on word
+inline void futex_wake(std::atomic<uint32_t>* word, int count = 1) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+#endif // FIBERS_FUTEX_HPP
@@ -0,0 +1,87 @@
+#ifndef FIBERS_MPSC_QUEUE_HPP
+#define FIBERS_MPSC_QUEUE_HPP
+
+#include <atomic>
+
+// Intrusive hook for mpsc_queue
+struct mpsc_node {
+    std::atomic<mpsc_node*> next{nullptr};
+};
+
+// Vyukov's intrusive multi-producer/single-consumer queue.
+//
+// push() is wait-free: one exchange plus one store, so producers never
+// block. pop() may only be called from the single consumer. While a producer
+// is between its exchange and its store the queue is briefly "in flight":
+// pop() returns nullptr but empty() is false, so the consumer should retry
+// rather than go to sleep.
+template<typename T>
+class mpsc_queue {
+private:
+    std::atomic<mpsc_node*> head_;  // Producers push here
+    mpsc_node* tail_;               // Consumer pops here
+    mpsc_node stub_;
+
+public:
+    mpsc_queue() : head_(&stub_), tail_(&stub_) {}
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    // Any thread
+    void push(T* item) {
+        push_node(static_cast<mpsc_node*>(item));
+    }
+
+    // Consumer only
+    T* pop() {
+        mpsc_node* tail = tail_;
+        mpsc_node* next = tail->next.load(std::memory_order_acquire);
+
+        // Skip over the stub node
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+
+        // tail is the last linked node; if a producer is mid-push, wait for it
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // Re-insert the stub so the last real node can be detached
+        push_node(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+    // Consumer only. False while a push is in flight.
+    bool empty() const {
+        // Any node other than the stub at the tail is still to be returned
+        return tail_ == &stub_ &&
+               stub_.next.load(std::memory_order_acquire) == nullptr &&
+               head_.load(std::memory_order_seq_cst) == &stub_;
+    }
+
+private:
+    void push_node(mpsc_node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        mpsc_node* prev = head_.exchange(node, std::memory_order_seq_cst);
+        prev->next.store(node, std::memory_order_release);
+    }
+};
+
+#endif // FIBERS_MPSC_QUEUE_HPP
@@ -0,0 +1,144 @@
+#ifndef FIBERS_PARALLEL_HPP
+#define FIBERS_PARALLEL_HPP
+
+#include "fiber_pool.hpp"
+#include "wait_group.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Fork-join building blocks on top of fiber_pool.
+//
+// Ranges are split in half recursively: the right half is posted to the pool
+// as a new fiber, the left half is processed in place, then the fiber joins.
+// Splitting stops at the grain size, below which a fiber costs more than it
+// saves. A grain of 0 picks one automatically (about 8 chunks per worker).
+//
+// Called from a plain thread, the root of the recursion is posted to the pool
+// and the thread blocks until it completes; called from a fiber in the pool,
+// the calling fiber takes part in the work.
+
+namespace parallel_detail {
+
+inline size_t auto_grain(const fiber_pool& pool, size_t n, size_t grain) {
+    if (grain != 0) {
+        return grain;
+    }
+    return std::max<size_t>(1, n / (pool.size() * 8));
+}
+
+inline bool in_fiber() {
+    scheduler* s = scheduler::current();
+    return s != nullptr && s->running() != nullptr;
+}
+
+// Run body on a pool fiber (or inline if already on one) and wait for it
+template<typename Body>
+void run_root(fiber_pool& pool, Body&& body) {
+    if (in_fiber()) {
+        body();
+        return;
+    }
+    wait_group done(1);
+    pool.post([&body, &done] {
+        body();
+        done.done();
+    });
+    done.wait();
+}
+
+template<typename F>
+void for_range(fiber_pool& pool, size_t begin, size_t end, size_t grain, F& fn) {
+    if (end - begin <= grain) {
+        for (size_t i = begin; i < end; i++) {
+            fn(i);
+        }
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    wait_group right(1);
+    pool.post([&pool, mid, end, grain, &fn, &right] {
+        for_range(pool, mid, end, grain, fn);
+        right.done();
+    });
+    for_range(pool, begin, mid, grain, fn);
+    right.wait();
+}
+
+template<typename T, typename Map, typename Reduce>
+T reduce_range(fiber_pool& pool, size_t begin, size_t end, size_t grain,
+               const T& identity, Map& map, Reduce& reduce) {
+    if (end - begin <= grain) {
+        T acc = identity;
+        for (size_t i = begin; i < end; i++) {
+            acc = reduce(std::move(acc), map(i));
+        }
+        return acc;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    T right_result = identity;
+    wait_group right(1);
+    pool.post([&, mid, end] {
+        right_result = reduce_range(pool, mid, end, grain, identity, map, reduce);
+        right.done();
+    });
+    T left_result = reduce_range(pool, begin, mid, grain, identity, map, reduce);
+    right.wait();
+    return reduce(std::move(left_result), std::move(right_result));
+}
+
+inline void invoke_rest(fiber_pool&, wait_group&) {}
+
+template<typename F, typename... Rest>
+void invoke_rest(fiber_pool& pool, wait_group& group, F& fn, Rest&... rest) {
+    pool.post([&fn, &group] {
+        fn();
+        group.done();
+    });
+    invoke_rest(pool, group, rest...);
+}
+
+} // namespace parallel_detail
+
+// fn(i) for every i in [begin, end)
+template<typename F>
+void parallel_for(fiber_pool& pool, size_t begin, size_t end, size_t grain, F fn) {
+    if (begin >= end) {
+        return;
+    }
+    grain = parallel_detail::auto_grain(pool, end - begin, grain);
+    parallel_detail::run_root(pool, [&] {
+        parallel_detail::for_range(pool, begin, end, grain, fn);
+    });
+}
+
+// reduce(...reduce(identity, map(begin))..., map(end - 1)), evaluated as a
+// tree; reduce must be associative and identity its neutral element
+template<typename T, typename Map, typename Reduce>
+T parallel_reduce(fiber_pool& pool, size_t begin, size_t end, size_t grain,
+                  T identity, Map map, Reduce reduce) {
+    if (begin >= end) {
+        return identity;
+    }
+    grain = parallel_detail::auto_grain(pool, end - begin, grain);
+    T result = identity;
+    parallel_detail::run_root(pool, [&] {
+        result = parallel_detail::reduce_range(pool, begin, end, grain,
+                                               identity, map, reduce);
+    });
+    return result;
+}
+
+// Run every function concurrently; the first runs on the calling fiber
+template<typename F, typename... Rest>
+void parallel_invoke(fiber_pool& pool, F first, Rest... rest) {
+    parallel_detail::run_root(pool, [&] {
+        wait_group group(sizeof...(Rest));
+        parallel_detail::invoke_rest(pool, group, rest...);
+        first();
+        group.wait();
+    });
+}
+
+#endif // FIBERS_PARALLEL_HPP
@@ -0,0 +1,338 @@
+#ifndef FIBERS_SCHEDULER_HPP
+#define FIBERS_SCHEDULER_HPP
+
+#include "context.hpp"
+#include "futex.hpp"
+#include "mpsc_queue.hpp"
+#include "stack_pool.hpp"
+#include "task.hpp"
+#include "../allocator/chunk_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class fiber;
+class scheduler;
+
+// Scratch arena owned by each fiber. It holds no memory until first used,
+// draws its chunks from the worker's chunk_pool and hands them all back in
+// one step when the fiber finishes.
+using fiber_arena = bump<16 * 1024, bump_growth::chained>;
+
+// A fiber starts as a descriptor: the callable, its captures and the stack
+// size it wants. The stack is attached when a scheduler first dispatches it
+// and handed back as soon as it finishes, so a backlog of queued fibers
+// costs no stack memory.
+class fiber : public mpsc_node {
+    friend class scheduler;
+
+public:
+    static constexpr size_t default_stack_size = 64 * 1024;
+
+private:
+    void* sp_ = nullptr;        // Saved stack pointer while suspended
+    char* stack_ = nullptr;     // Only between first dispatch and finish
+    size_t stack_size_;
+    stack_pool* stacks_ = nullptr;  // Where stack_ comes from; nullptr = new[]
+    task func;
+    fiber_arena arena_;
+    scheduler* owner_ = nullptr;
+    bool started_ = false;
+    bool finished_ = false;
+    bool detached_ = false;     // Created by scheduler::spawn(f, args...)
+
+public:
+    // f is any void() callable; it is moved into the fiber, never copied
+    // (pass an rvalue, or std::move an lvalue, to avoid copying it in)
+    template<typename F,
+             typename = typename std::enable_if<!std::is_same<F, fiber>::value>::type>
+    explicit fiber(F f, size_t stack_size = default_stack_size)
+        : stack_size_(stack_size), func(std::move(f)) {}
+
+    // As above, with a stack from stacks (which must outlive the fiber)
+    template<typename F,
+             typename = typename std::enable_if<!std::is_same<F, fiber>::value>::type>
+    fiber(F f, stack_pool& stacks)
+        : stack_size_(stacks.stack_size()), stacks_(&stacks), func(std::move(f)) {}
+
+    // Only a fiber destroyed while suspended still has its stack
+    ~fiber() {
+        if (stack_ == nullptr) {
+            return;
+        }
+        if (stacks_ != nullptr) {
+            stacks_->release(stack_);
+        } else {
+            delete[] stack_;
+        }
+    }
+
+    fiber(const fiber&) = delete;
+    fiber& operator=(const fiber&) = delete;
+
+    bool finished() const { return finished_; }
+
+    // True from first dispatch until the fiber finishes
+    bool has_stack() const { return stack_ != nullptr; }
+
+    fiber_arena& arena() { return arena_; }
+
+private:
+    static void entry(void* arg);
+};
+
+class scheduler {
+public:
+    // Default-size stacks kept for reuse after their fibers finish
+    static constexpr size_t spare_stack_limit = 64;
+
+    // Most fibers moved from the inbox per loop iteration, so steady
+    // cross-thread posting cannot keep run() from the local queue
+    static constexpr size_t inbox_batch = 256;
+
+private:
+    std::deque<fiber*> fibers_;         // Local run queue, owner thread only
+    mpsc_queue<fiber> inbox_;           // Cross-thread spawns and wake-ups
+    void* sp_ = nullptr;                // Scheduler stack while a fiber runs
+    fiber* current_ = nullptr;
+    chunk_pool chunks_;                 // Backs the arenas of fibers run here
+    size_t live_ = 0;                   // Started but not yet finished
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint32_t> sleeping_{0}; // Futex word, 1 while parked in run()
+    std::vector<char*> spare_stacks_;   // Freed default-size new[] stacks
+    std::atomic<size_t> dispatches_{0}; // Owner writes, anyone may read
+
+public:
+    scheduler() = default;
+
+    ~scheduler() {
+        for (char* stack : spare_stacks_) {
+            delete[] stack;
+        }
+    }
+
+    scheduler(const scheduler&) = delete;
+    scheduler& operator=(const scheduler&) = delete;
+
+    // Scheduler driving the calling thread, or nullptr
+    static scheduler*& current() {
+        static thread_local scheduler* instance = nullptr;
+        return instance;
+    }
+
+    // Owner thread only. The caller keeps ownership of f.
+    void spawn(fiber* f) {
+        f->owner_ = this;
+        fibers_.push_back(f);
+    }
+
+    // Owner thread only: run fn(args...) on a new fiber that the scheduler
+    // deletes once it finishes. fn and args are moved into the fiber.
+    template<typename F, typename... Args>
+    void spawn(F fn, Args... args) {
+        spawn(make_detached(std::move(fn), std::move(args)...));
+    }
+
+    // Any thread: queue f (new or suspended) and wake the scheduler if parked.
+    // Never blocks.
+    void post(fiber* f) {
+        f->owner_ = this;
+        inbox_.push(f);
+        wake();
+    }
+
+    // Any thread: like spawn(fn, args...), but through the inbox
+    template<typename F, typename... Args>
+    void post(F fn, Args... args) {
+        post(make_detached(std::move(fn), std::move(args)...));
+    }
+
+    // Run the next ready fiber until it yields, suspends or exits
+    void do_it() {
+        drain_inbox();
+        if (!fibers_.empty()) {
+            fiber* f = fibers_.front();
+            fibers_.pop_front();
+            resume(f);
+        }
+    }
+
+    // Run fibers until stop() has been requested and every started fiber has
+    // finished. Parks the thread while idle; post() and stop() wake it up.
+    void run() {
+        for (;;) {
+            drain_inbox();
+            if (!fibers_.empty()) {
+                fiber* f = fibers_.front();
+                fibers_.pop_front();
+                resume(f);
+                continue;
+            }
+            if (!inbox_.empty()) {
+                continue;   // A producer is mid-push
+            }
+            if (live_ == 0 && stopping_.load(std::memory_order_acquire)) {
+                return;
+            }
+            park();
+        }
+    }
+
+    // Any thread: ask run() to return once it is idle
+    void stop() {
+        stopping_.store(true, std::memory_order_seq_cst);
+        wake();
+    }
+
+    // Called from a fiber: requeue it and switch back to the scheduler
+    void yield() {
+        fiber* f = current_;
+        fibers_.push_back(f);
+        fibers_switch_stack(&f->sp_, sp_);
+    }
+
+    // Called from a fiber: switch back without requeueing. Someone must later
+    // post() or spawn() the fiber to resume it.
+    void suspend() {
+        fibers_switch_stack(&current_->sp_, sp_);
+    }
+
+    // Called from a fiber: finish it and return to the scheduler loop
+    NORETURN void fiber_exit() {
+        current_->finished_ = true;
+        fibers_switch_stack(&current_->sp_, sp_);
+        __builtin_unreachable();
+    }
+
+    fiber* running() const { return current_; }
+
+    // Any thread: fibers resumed so far. Each is a switch into a fiber and
+    // one back out.
+    size_t dispatches() const { return dispatches_.load(std::memory_order_relaxed); }
+
+    chunk_pool& chunks() { return chunks_; }
+
+private:
+    template<typename F, typename... Args>
+    static fiber* make_detached(F fn, Args... args) {
+        fiber* f;
+        if constexpr (sizeof...(Args) == 0) {
+            f = new fiber(std::move(fn));
+        } else {
+            f = new fiber(
+                [fn = std::move(fn),
+                 bound = std::make_tuple(std::move(args)...)]() mutable {
+                    std::apply(std::move(fn), std::move(bound));
+                });
+        }
+        f->detached_ = true;
+        return f;
+    }
+
+    void resume(fiber* f) {
+        scheduler*& tls = current();
+        scheduler* previous = tls;
+        tls = this;
+        current_ = f;
+        if (!f->started_) {
+            attach_stack(f);
+            f->started_ = true;
+            f->arena_.set_source(chunks_);
+            live_++;
+        }
+        dispatches_.store(dispatches_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        fibers_switch_stack(&sp_, f->sp_);
+        current_ = nullptr;
+        tls = previous;
+        if (f->finished_) {
+            f->arena_.release();
+            detach_stack(f);
+            live_--;
+            if (f->detached_) {
+                delete f;
+            }
+        }
+    }
+
+    // A fiber that finishes without suspending gives its stack back before
+    // the next dispatch, so a run of such fibers keeps reusing one hot stack
+    void attach_stack(fiber* f) {
+        if (f->stacks_ != nullptr) {
+            f->stack_ = f->stacks_->acquire();
+        } else if (f->stack_size_ == fiber::default_stack_size && !spare_stacks_.empty()) {
+            f->stack_ = spare_stacks_.back();
+            spare_stacks_.pop_back();
+        } else {
+            f->stack_ = new char[f->stack_size_];
+        }
+        f->sp_ = make_stack_context(f->stack_ + f->stack_size_, &fiber::entry, f);
+    }
+
+    void detach_stack(fiber* f) {
+        if (f->stacks_ != nullptr) {
+            f->stacks_->release(f->stack_);
+        } else if (f->stack_size_ == fiber::default_stack_size &&
+                   spare_stacks_.size() < spare_stack_limit) {
+            spare_stacks_.push_back(f->stack_);
+        } else {
+            delete[] f->stack_;
+        }
+        f->stack_ = nullptr;
+    }
+
+    // One batch per loop iteration
+    void drain_inbox() {
+        for (size_t i = 0; i < inbox_batch; i++) {
+            fiber* f = inbox_.pop();
+            if (f == nullptr) {
+                return;
+            }
+            fibers_.push_back(f);
+        }
+    }
+
+    void park() {
+        sleeping_.store(1, std::memory_order_seq_cst);
+        // Re-check after announcing the sleep so a concurrent post() either
+        // sees sleeping_ == 1 or we see its push
+        if (inbox_.empty() && !stopping_.load(std::memory_order_seq_cst)) {
+            futex_wait(&sleeping_, 1);
+        }
+        sleeping_.store(0, std::memory_order_relaxed);
+    }
+
+    void wake() {
+        if (sleeping_.load(std::memory_order_seq_cst) != 0 &&
+            sleeping_.exchange(0, std::memory_order_seq_cst) != 0) {
+            futex_wake(&sleeping_);
+        }
+    }
+};
+
+// Arena for scratch allocations: the running fiber's own arena, or a
+// per-thread arena when called outside a fiber. Fiber arenas are released
+// when the fiber finishes; fibers must stay on the scheduler that first ran
+// them, since the chunks go back to that worker's pool.
+inline fiber_arena& current_arena() {
+    scheduler* s = scheduler::current();
+    if (s != nullptr && s->running() != nullptr) {
+        return s->running()->arena();
+    }
+    static thread_local fiber_arena thread_arena;
+    return thread_arena;
+}
+
+inline void fiber::entry(void* arg) {
+    fiber* self = static_cast<fiber*>(arg);
+    self->func();
+    self->owner_->fiber_exit();
+}
+
+#endif // FIBERS_SCHEDULER_HPP
@@ -0,0 +1,84 @@
+#ifndef FIBERS_STACK_POOL_HPP
+#define FIBERS_STACK_POOL_HPP
+
+#include "../allocator/bump_allocator.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Fixed-size fiber stacks carved from large regions of a chunk_source. With a
+// page_source behind it the stacks sit on huge pages (the default region of
+// 32 x 64KB is exactly one 2MB page) and can be prefaulted up front. Stacks
+// are recycled through a free list and the regions are only returned when
+// the pool is destroyed, so it must outlive every fiber using it.
+//
+// Stacks from a region have no guard pages between them.
+class stack_pool {
+private:
+    struct free_stack {
+        free_stack* next;
+    };
+
+    chunk_source* source_;
+    size_t stack_size_;
+    size_t stacks_per_region_;
+    std::mutex lock_;
+    free_stack* free_ = nullptr;
+    std::vector<void*> regions_;
+
+public:
+    explicit stack_pool(size_t stack_size = 64 * 1024,
+                        chunk_source& source = heap_chunk_source::instance(),
+                        size_t stacks_per_region = 32)
+        : source_(&source), stack_size_((stack_size + 15) & ~size_t(15)),
+          stacks_per_region_(stacks_per_region) {}
+
+    ~stack_pool() {
+        for (void* region : regions_) {
+            source_->release(region, stack_size_ * stacks_per_region_);
+        }
+    }
+
+    stack_pool(const stack_pool&) = delete;
+    stack_pool& operator=(const stack_pool&) = delete;
+
+    // Any thread. Throws std::bad_alloc when the source is out of memory.
+    char* acquire() {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (free_ == nullptr) {
+            add_region();
+        }
+        free_stack* s = free_;
+        free_ = s->next;
+        return reinterpret_cast<char*>(s);
+    }
+
+    // Any thread
+    void release(char* stack) {
+        free_stack* s = reinterpret_cast<free_stack*>(stack);
+        std::lock_guard<std::mutex> guard(lock_);
+        s->next = free_;
+        free_ = s;
+    }
+
+    size_t stack_size() const { return stack_size_; }
+
+private:
+    void add_region() {
+        void* region = source_->acquire(stack_size_ * stacks_per_region_);
+        if (region == nullptr) {
+            throw std::bad_alloc();
+        }
+        regions_.push_back(region);
+        char* base = static_cast<char*>(region);
+        for (size_t i = stacks_per_region_; i-- > 0;) {
+            free_stack* s = reinterpret_cast<free_stack*>(base + i * stack_size_);
+            s->next = free_;
+            free_ = s;
+        }
+    }
+};
+
+#endif // FIBERS_STACK_POOL_HPP
@@ -0,0 +1,127 @@
+#ifndef FIBERS_STATIC_SCHEDULER_HPP
+#define FIBERS_STATIC_SCHEDULER_HPP
+
+#include "context.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+// Scheduler for a set of fibers fixed at compile time, for programs that
+// know every fiber they will run when they are built.
+//
+// Each fiber is a static_fiber<entry, stack size>. The stacks and control
+// blocks of a static_scheduler<Fibers...> are static arrays sized from the
+// template arguments, so nothing is allocated, and the round-robin loop is
+// unrolled over the fiber list. Entry points are plain functions that call
+// S::yield() to give way; a fiber finishes when its entry point returns.
+//
+//     void producer();
+//     void consumer();
+//     using app = static_scheduler<static_fiber<producer>, static_fiber<consumer, 8192>>;
+//     void producer() { ...; app::yield(); ... }
+//     ...
+//     app::run();
+//
+// All state belongs to the type: one thread at a time may run a given
+// static_scheduler. Its fibers have no arena and cannot block on the dynamic
+// scheduler's primitives (wait_group, channel).
+template<void (*Entry)(), size_t StackSize = 16 * 1024>
+struct static_fiber {
+    static constexpr void (*entry)() = Entry;
+    static constexpr size_t stack_size = (StackSize + 15) & ~size_t(15);
+
+    static_assert(StackSize >= 1024, "static_fiber: stack too small for a context frame");
+};
+
+template<typename... Fibers>
+class static_scheduler {
+    static_assert(sizeof...(Fibers) > 0, "static_scheduler needs at least one fiber");
+
+public:
+    static constexpr size_t fiber_count = sizeof...(Fibers);
+
+private:
+    struct control {
+        void* sp;           // Saved stack pointer while suspended
+        bool finished;
+    };
+
+    static constexpr size_t stack_sizes[] = {Fibers::stack_size...};
+
+    static constexpr size_t stack_offset(size_t index) {
+        size_t offset = 0;
+        for (size_t i = 0; i < index; i++) {
+            offset += stack_sizes[i];
+        }
+        return offset;
+    }
+
+    static constexpr size_t total_stack = stack_offset(fiber_count);
+
+    alignas(64) static inline char stacks_[total_stack];
+    static inline control blocks_[fiber_count];
+    static inline void* sp_ = nullptr;      // run()'s stack while a fiber runs
+    static inline size_t current_ = 0;
+    static inline size_t live_ = 0;
+
+    template<size_t I>
+    using fiber_at = typename std::tuple_element<I, std::tuple<Fibers...>>::type;
+
+public:
+    static_scheduler() = delete;
+
+    // Start every fiber and run them round-robin until all have finished.
+    // May be called again afterwards to run the set from the start.
+    static void run() {
+        run(std::make_index_sequence<fiber_count>());
+    }
+
+    // Called from a fiber: switch to the next unfinished one
+    static void yield() {
+        fibers_switch_stack(&blocks_[current_].sp, sp_);
+    }
+
+    // Index of the running fiber, in template argument order
+    static size_t running() { return current_; }
+
+    static constexpr size_t stack_bytes() { return total_stack; }
+
+private:
+    template<size_t... I>
+    static void run(std::index_sequence<I...>) {
+        (start<I>(), ...);
+        live_ = fiber_count;
+        while (live_ != 0) {
+            (step<I>(), ...);
+        }
+    }
+
+    template<size_t I>
+    static void start() {
+        char* top = stacks_ + stack_offset(I) + stack_sizes[I];
+        blocks_[I] = {make_stack_context(top, &entry<I>, nullptr), false};
+    }
+
+    template<size_t I>
+    static void step() {
+        if (blocks_[I].finished) {
+            return;
+        }
+        current_ = I;
+        fibers_switch_stack(&sp_, blocks_[I].sp);
+        if (blocks_[I].finished) {
+            live_--;
+        }
+    }
+
+    template<size_t I>
+    NORETURN static void entry(void*) {
+        fiber_at<I>::entry();
+        blocks_[I].finished = true;
+        fibers_switch_stack(&blocks_[I].sp, sp_);
+        __builtin_unreachable();
+    }
+};
+
+#endif // FIBERS_STATIC_SCHEDULER_HPP
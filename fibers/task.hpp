@@ -0,0 +1,118 @@
+#ifndef FIBERS_TASK_HPP
+#define FIBERS_TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only, type-erased void() callable with a small inline buffer.
+//
+// Callables up to inline_size bytes (and at most max_align_t aligned, nothrow
+// movable) are moved straight into the buffer, so building a task never
+// allocates. Larger captures fall back to a single heap allocation.
+class task {
+public:
+    static constexpr size_t inline_size = 64;
+
+private:
+    struct ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;   // Leaves src destroyed
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr bool fits_inline =
+        sizeof(F) <= inline_size &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<F>::value;
+
+    template<typename F>
+    struct inline_ops {
+        static void invoke(void* s) { (*static_cast<F*>(s))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* s) noexcept { static_cast<F*>(s)->~F(); }
+        static constexpr ops table{invoke, move, destroy};
+    };
+
+    template<typename F>
+    struct heap_ops {
+        static F*& ptr(void* s) { return *static_cast<F**>(s); }
+        static void invoke(void* s) { (*ptr(s))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) F*(ptr(src));
+        }
+        static void destroy(void* s) noexcept { delete ptr(s); }
+        static constexpr ops table{invoke, move, destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[inline_size];
+    const ops* ops_ = nullptr;
+
+public:
+    task() noexcept = default;
+
+    // Takes f by value and moves it into place; the task never copies it
+    template<typename F,
+             typename = typename std::enable_if<!std::is_same<F, task>::value>::type>
+    task(F f) {
+        if constexpr (fits_inline<F>) {
+            ::new (static_cast<void*>(storage_)) F(std::move(f));
+            ops_ = &inline_ops<F>::table;
+        } else {
+            ::new (static_cast<void*>(storage_)) F*(new F(std::move(f)));
+            ops_ = &heap_ops<F>::table;
+        }
+    }
+
+    task(task&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() {
+        reset();
+    }
+
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    // True if a callable of type F would be stored without allocating
+    template<typename F>
+    static constexpr bool stored_inline() {
+        return fits_inline<typename std::decay<F>::type>;
+    }
+};
+
+#endif // FIBERS_TASK_HPP
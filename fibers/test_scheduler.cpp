@@ -0,0 +1,552 @@
+#include "scheduler.hpp"
+#include "parallel.hpp"
+#include "channel.hpp"
+#include "static_scheduler.hpp"
+#include "../allocator/page_source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple test framework
+#define TEST(name) void name()
+#define ASSERT(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << #condition << std::endl; \
+            std::cerr << "  at " << __FILE__ << ":" << __LINE__ << std::endl; \
+            exit(1); \
+        } \
+    } while (0)
+
+std::vector<int> trace;
+
+void record_1() { trace.push_back(1); }
+void record_2() { trace.push_back(2); }
+
+void yield_twice_a() {
+    trace.push_back(10);
+    scheduler::current()->yield();
+    trace.push_back(11);
+    scheduler::current()->yield();
+    trace.push_back(12);
+}
+
+void yield_twice_b() {
+    trace.push_back(20);
+    scheduler::current()->yield();
+    trace.push_back(21);
+    scheduler::current()->yield();
+    trace.push_back(22);
+}
+
+// Test 7.1: Fibers run on their own stacks in spawn order
+TEST(test_spawn_order) {
+    std::cout << "\n=== Test 7.1: Spawn Order ===\n";
+    trace.clear();
+    scheduler s;
+    fiber f1(record_1);
+    fiber f2(record_2);
+
+    s.spawn(&f1);
+    s.spawn(&f2);
+    s.do_it();
+    s.do_it();
+
+    ASSERT(f1.finished() && f2.finished());
+    ASSERT((trace == std::vector<int>{1, 2}));
+    std::cout << "Spawn order test passed\n";
+}
+
+// Test 7.2: yield() interleaves fibers round-robin
+TEST(test_yield_round_robin) {
+    std::cout << "\n=== Test 7.2: Yield Round-Robin ===\n";
+    trace.clear();
+    scheduler s;
+    fiber a(yield_twice_a);
+    fiber b(yield_twice_b);
+
+    s.spawn(&a);
+    s.spawn(&b);
+    s.stop();
+    s.run();
+
+    ASSERT((trace == std::vector<int>{10, 20, 11, 21, 12, 22}));
+    std::cout << "Yield round-robin test passed\n";
+}
+
+std::atomic<int> remote_runs{0};
+void count_remote() { remote_runs.fetch_add(1, std::memory_order_relaxed); }
+
+// Test 7.3: Several threads post into the inbox of a running scheduler
+TEST(test_cross_thread_post) {
+    std::cout << "\n=== Test 7.3: Cross-Thread Post ===\n";
+    constexpr int producers = 4;
+    constexpr int per_producer = 500;
+
+    remote_runs = 0;
+    scheduler s;
+    std::vector<fiber*> fibers;
+    for (int i = 0; i < producers * per_producer; i++) {
+        fibers.push_back(new fiber(count_remote, 4096));
+    }
+
+    std::thread consumer([&s] { s.run(); });
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&s, &fibers, p] {
+            for (int i = 0; i < per_producer; i++) {
+                s.post(fibers[p * per_producer + i]);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    s.stop();
+    consumer.join();
+
+    ASSERT(remote_runs.load() == producers * per_producer);
+    for (fiber* f : fibers) {
+        ASSERT(f->finished());
+        delete f;
+    }
+    std::cout << "Cross-thread post test passed\n";
+}
+
+fiber* parked = nullptr;
+std::atomic<bool> parked_ready{false};
+std::atomic<bool> resumed{false};
+
+void park_and_resume() {
+    parked = scheduler::current()->running();
+    parked_ready.store(true, std::memory_order_release);
+    scheduler::current()->suspend();
+    resumed.store(true, std::memory_order_release);
+}
+
+// Test 7.4: A suspended fiber is woken from another thread while the
+// scheduler is parked
+TEST(test_cross_thread_wake) {
+    std::cout << "\n=== Test 7.4: Cross-Thread Wake ===\n";
+    scheduler s;
+    fiber f(park_and_resume);
+    s.spawn(&f);
+
+    std::thread consumer([&s] { s.run(); });
+    while (!parked_ready.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    // Give the scheduler a chance to go to sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT(!resumed.load());
+
+    s.post(parked);
+    s.stop();
+    consumer.join();
+
+    ASSERT(resumed.load());
+    ASSERT(f.finished());
+    std::cout << "Cross-thread wake test passed\n";
+}
+
+// Test 7.5: spawn() takes any callable plus arguments, moved in
+TEST(test_spawn_callable) {
+    std::cout << "\n=== Test 7.5: Spawn Callable With Arguments ===\n";
+    scheduler s;
+    int sum = 0;
+    std::string joined;
+    auto owned = std::make_unique<int>(5);
+
+    s.spawn([&sum](int a, int b) { sum = a + b; }, 2, 3);
+    s.spawn([&joined](std::string a, const std::string& b) { joined = a + b; },
+            std::string("fi"), std::string("ber"));
+    s.spawn([&sum, p = std::move(owned)]() { sum += *p; });
+    ASSERT(owned == nullptr);
+
+    s.stop();
+    s.run();
+
+    ASSERT(sum == 10);
+    ASSERT(joined == "fiber");
+
+    // Callables and bound arguments are moved into spawned fibers, never
+    // copied
+    struct counted {
+        int* copies;
+        explicit counted(int* c) : copies(c) {}
+        counted(const counted& other) : copies(other.copies) { (*copies)++; }
+        counted(counted&&) noexcept = default;
+        void operator()(counted) {}
+    };
+    int copies = 0;
+    {
+        scheduler moves;
+        counted fn(&copies), arg(&copies);
+        moves.spawn(std::move(fn), std::move(arg));
+        moves.spawn(counted(&copies), counted(&copies));
+        moves.stop();
+        moves.run();
+    }
+    ASSERT(copies == 0);
+    std::cout << "Spawn callable test passed\n";
+}
+
+// Test 7.6: Small captures live inline in the task, large ones on the heap
+TEST(test_task_storage) {
+    std::cout << "\n=== Test 7.6: Task Inline Storage ===\n";
+    struct small { char bytes[32]; void operator()() {} };
+    struct large { char bytes[128]; void operator()() {} };
+    ASSERT(task::stored_inline<small>());
+    ASSERT(!task::stored_inline<large>());
+
+    int calls = 0;
+    task a([&calls] { calls++; });
+    task b(std::move(a));
+    ASSERT(!a);
+    b();
+
+    char big[128] = {1};
+    task c([&calls, big] { calls += big[0]; });
+    task d;
+    d = std::move(c);
+    d();
+    ASSERT(calls == 2);
+    std::cout << "Task storage test passed\n";
+}
+
+// Test 7.7: parallel_for touches every index exactly once
+TEST(test_parallel_for) {
+    std::cout << "\n=== Test 7.7: parallel_for ===\n";
+    fiber_pool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+
+    parallel_for(pool, 0, hits.size(), 0, [&hits](size_t i) {
+        hits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+    parallel_for(pool, 0, hits.size(), 7, [&hits](size_t i) {
+        hits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    for (auto& h : hits) {
+        ASSERT(h.load() == 2);
+    }
+
+    // Forks made while the pool is being destroyed still run: workers that
+    // went idle first must not have stopped yet
+    std::atomic<size_t> late{0};
+    {
+        fiber_pool closing(4);
+        closing.post([&closing, &late] {
+            auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+            while (std::chrono::steady_clock::now() < until) {}
+            parallel_for(closing, 0, 1000, 10, [&late](size_t) {
+                late.fetch_add(1, std::memory_order_relaxed);
+            });
+        });
+    }
+    ASSERT(late.load() == 1000);
+    std::cout << "parallel_for test passed\n";
+}
+
+// Test 7.8: parallel_reduce matches the serial result
+TEST(test_parallel_reduce) {
+    std::cout << "\n=== Test 7.8: parallel_reduce ===\n";
+    fiber_pool pool(3);
+    std::vector<long long> values(100000);
+    std::iota(values.begin(), values.end(), 1);
+
+    long long sum = parallel_reduce(pool, 0, values.size(), 0, 0LL,
+        [&values](size_t i) { return values[i]; },
+        [](long long a, long long b) { return a + b; });
+    ASSERT(sum == 100000LL * 100001LL / 2);
+
+    long long empty = parallel_reduce(pool, 5, 5, 0, 42LL,
+        [](size_t) { return 0LL; },
+        [](long long a, long long b) { return a + b; });
+    ASSERT(empty == 42);
+    std::cout << "parallel_reduce test passed\n";
+}
+
+void parallel_sort(fiber_pool& pool, int* first, int* last) {
+    if (last - first <= 1024) {
+        std::sort(first, last);
+        return;
+    }
+    int* mid = first + (last - first) / 2;
+    parallel_invoke(pool,
+        [&pool, first, mid] { parallel_sort(pool, first, mid); },
+        [&pool, mid, last] { parallel_sort(pool, mid, last); });
+    std::inplace_merge(first, mid, last);
+}
+
+// Test 7.9: nested parallel_invoke (merge sort)
+TEST(test_parallel_invoke) {
+    std::cout << "\n=== Test 7.9: parallel_invoke ===\n";
+    fiber_pool pool(4);
+    std::vector<int> values(50000);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<int>((i * 2654435761u) % 100003);
+    }
+
+    parallel_sort(pool, values.data(), values.data() + values.size());
+    ASSERT(std::is_sorted(values.begin(), values.end()));
+
+    std::atomic<int> ran{0};
+    parallel_invoke(pool,
+        [&ran] { ran++; }, [&ran] { ran++; }, [&ran] { ran++; });
+    ASSERT(ran.load() == 3);
+    std::cout << "parallel_invoke test passed\n";
+}
+
+// Test 7.10: Each fiber gets its own arena, released when it finishes
+TEST(test_fiber_arena) {
+    std::cout << "\n=== Test 7.10: Per-Fiber Arena ===\n";
+    scheduler s;
+    fiber_arena* arenas[2] = {nullptr, nullptr};
+
+    for (int i = 0; i < 2; i++) {
+        s.spawn([&arenas, i] {
+            fiber_arena& a = current_arena();
+            arenas[i] = &a;
+            int* values = a.alloc<int>(1000);
+            for (int j = 0; j < 1000; j++) {
+                values[j] = j;
+            }
+            scheduler::current()->yield();
+            ASSERT(values[999] == 999);
+            ASSERT(a.get_allocation_count() == 1);
+        });
+    }
+    s.stop();
+    s.run();
+
+    ASSERT(arenas[0] != nullptr && arenas[0] != arenas[1]);
+    // Both fibers' chunks went back to the worker's pool
+    size_t cached = s.chunks().cached_bytes();
+    ASSERT(cached >= 2 * 16 * 1024);
+
+    // The next fiber reuses them instead of going to the heap
+    s.spawn([] { ASSERT(current_arena().alloc<char>(100) != nullptr); });
+    s.run();
+    ASSERT(s.chunks().cached_bytes() == cached);
+
+    // Outside a fiber, current_arena() is a per-thread arena
+    ASSERT(&current_arena() == &current_arena());
+    std::cout << "Per-fiber arena test passed\n";
+}
+
+// Test 7.11: Fibers on stacks from a huge-page stack_pool
+TEST(test_stack_pool) {
+    std::cout << "\n=== Test 7.11: Pooled Fiber Stacks ===\n";
+    page_source pages(page_mode::transparent_huge, true);
+    stack_pool stacks(64 * 1024, pages);
+    scheduler s;
+
+    int sum = 0;
+    std::vector<uintptr_t> frames;
+    {
+        std::vector<std::unique_ptr<fiber>> fibers;
+        for (int i = 0; i < 40; i++) {     // More than one region
+            fibers.push_back(std::make_unique<fiber>([&sum, &frames, i] {
+                char local[1024];
+                local[0] = static_cast<char>(i);
+                frames.push_back(reinterpret_cast<uintptr_t>(local));
+                scheduler::current()->yield();
+                sum += local[0];
+            }, stacks));
+            s.spawn(fibers.back().get());
+        }
+        s.stop();
+        s.run();
+    }
+    ASSERT(sum == 39 * 40 / 2);
+    std::cout << "Stack pages: " << page_mode_name(pages.obtained()) << "\n";
+
+    // Freed stacks are reused: a new fiber's frame lands in one of the old
+    // stacks (the regions are 2MB-aligned, so a stack is a 64KB-aligned slot)
+    uintptr_t frame = 0;
+    fiber again([&frame] {
+        char local[1024];
+        frame = reinterpret_cast<uintptr_t>(local);
+    }, stacks);
+    s.spawn(&again);
+    s.run();
+    bool reused = false;
+    for (uintptr_t old : frames) {
+        reused = reused || old / stacks.stack_size() == frame / stacks.stack_size();
+    }
+    ASSERT(reused);
+    std::cout << "Pooled stack test passed\n";
+}
+
+// Test 7.12: Stacks are attached at first dispatch and returned at finish
+TEST(test_lazy_stacks) {
+    std::cout << "\n=== Test 7.12: Lazy Fiber Stacks ===\n";
+    scheduler s;
+
+    // Queued fibers hold no stack
+    bool had_stack = false;
+    fiber f([&had_stack] { had_stack = scheduler::current()->running()->has_stack(); });
+    s.spawn(&f);
+    ASSERT(!f.has_stack());
+    s.do_it();
+    ASSERT(had_stack && f.finished() && !f.has_stack());
+
+    // Fibers that never suspend reuse the stack the previous one gave back
+    std::vector<uintptr_t> frames;
+    for (int i = 0; i < 100; i++) {
+        s.spawn([&frames] {
+            char local[16];
+            frames.push_back(reinterpret_cast<uintptr_t>(local));
+        });
+    }
+    s.stop();
+    s.run();
+    ASSERT(frames.size() == 100);
+    ASSERT(std::all_of(frames.begin(), frames.end(), [&](uintptr_t p) { return p == frames[0]; }));
+
+    // Suspended fibers each keep their own
+    frames.clear();
+    for (int i = 0; i < 4; i++) {
+        s.spawn([&frames] {
+            char local[16];
+            frames.push_back(reinterpret_cast<uintptr_t>(local));
+            scheduler::current()->yield();
+        });
+    }
+    s.run();
+    std::sort(frames.begin(), frames.end());
+    ASSERT(std::unique(frames.begin(), frames.end()) == frames.end() && frames.size() == 4);
+    std::cout << "Lazy stack test passed\n";
+}
+
+// Test 7.13: Channels block fibers on full and empty buffers
+TEST(test_channel) {
+    std::cout << "\n=== Test 7.13: Channels ===\n";
+    {
+        // One scheduler: the producer blocks once two items are buffered
+        scheduler s;
+        channel<int> ch(2);
+        std::vector<int> received;
+        trace.clear();
+        s.spawn([&] {
+            for (int i = 0; i < 5; i++) {
+                ch.send(i);
+                trace.push_back(i);
+            }
+            ch.close();
+        });
+        s.spawn([&] {
+            while (std::optional<int> v = ch.receive()) {
+                received.push_back(*v);
+            }
+        });
+        s.stop();
+        s.run();
+        ASSERT((received == std::vector<int>{0, 1, 2, 3, 4}));
+        ASSERT(trace.size() == 5 && ch.receive().has_value() == false);
+    }
+    {
+        // Closing wakes a sender blocked on a full buffer
+        scheduler s;
+        channel<int> ch(1);
+        std::vector<int> sent;
+        s.spawn([&] {
+            for (int i = 0; i < 3; i++) {
+                sent.push_back(ch.send(i) ? 1 : 0);
+            }
+        });
+        s.spawn([&] { ch.close(); });
+        s.stop();
+        s.run();
+        ASSERT((sent == std::vector<int>{1, 0, 0}));
+        ASSERT(*ch.receive() == 0 && ch.receive().has_value() == false);
+    }
+
+    // Ping-pong between fibers on different threads
+    constexpr int rounds = 10000;
+    long total = 0;
+    {
+        fiber_pool pool(2);
+        channel<int> ping, pong;
+        wait_group done(2);
+        pool.worker(0).post([&] {
+            for (int i = 0; i < rounds; i++) {
+                ping.send(i);
+                total += *pong.receive();
+            }
+            done.done();
+        });
+        pool.worker(1).post([&] {
+            for (int i = 0; i < rounds; i++) {
+                pong.send(*ping.receive() + 1);
+            }
+            done.done();
+        });
+        done.wait();
+    }
+    ASSERT(total == static_cast<long>(rounds) * (rounds + 1) / 2);
+    std::cout << "Channel test passed\n";
+}
+
+// Test 7.14: A fixed fiber set runs round-robin on static stacks
+void static_a();
+void static_b();
+void static_c();
+using static_set = static_scheduler<static_fiber<static_a>,
+                                    static_fiber<static_b, 8192>,
+                                    static_fiber<static_c, 4000>>;
+
+void static_a() {
+    for (int i = 0; i < 3; i++) {
+        trace.push_back(10 + i);
+        static_set::yield();
+    }
+}
+
+void static_b() {
+    trace.push_back(20 + static_cast<int>(static_set::running()));
+    static_set::yield();
+    trace.push_back(22);
+}
+
+void static_c() {
+    trace.push_back(30);
+}
+
+TEST(test_static_scheduler) {
+    std::cout << "\n=== Test 7.14: Static scheduler ===\n";
+    static_assert(static_set::fiber_count == 3);
+    static_assert(static_set::stack_bytes() == 16 * 1024 + 8192 + 4000);
+
+    for (int pass = 0; pass < 2; pass++) {
+        trace.clear();
+        static_set::run();
+        ASSERT((trace == std::vector<int>{10, 21, 30, 11, 22, 12}));
+    }
+    std::cout << "Static scheduler test passed\n";
+}
+
+int main() {
+    test_spawn_order();
+    test_yield_round_robin();
+    test_cross_thread_post();
+    test_cross_thread_wake();
+    test_spawn_callable();
+    test_task_storage();
+    test_parallel_for();
+    test_parallel_reduce();
+    test_parallel_invoke();
+    test_fiber_arena();
+    test_stack_pool();
+    test_lazy_stacks();
+    test_channel();
+    test_static_scheduler();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef FIBERS_WAIT_GROUP_HPP
+#define FIBERS_WAIT_GROUP_HPP
+
+#include "futex.hpp"
+#include "scheduler.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Join point for a fixed number of children and a single waiter.
+//
+// A fiber that waits is suspended and posted back to its scheduler by the
+// last done(); a plain thread that waits blocks on a futex. The counter
+// starts at count + 1 so that whoever takes it to zero (the last child or
+// the waiter itself) knows nobody else will touch the group.
+class wait_group {
+private:
+    static constexpr uint32_t idle = 0;
+    static constexpr uint32_t waking = 1;
+    static constexpr uint32_t released = 2;
+
+    std::atomic<uint32_t> pending_;
+    std::atomic<uint32_t> woken_{0};    // Futex word for a thread waiter:
+                                        // idle, then waking, then released
+    fiber* waiter_ = nullptr;
+    scheduler* waiter_sched_ = nullptr;
+
+public:
+    explicit wait_group(uint32_t count) : pending_(count + 1) {}
+
+    wait_group(const wait_group&) = delete;
+    wait_group& operator=(const wait_group&) = delete;
+
+    // Any thread, once per child
+    void done() {
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (waiter_sched_ != nullptr) {
+                waiter_sched_->post(waiter_);
+            } else {
+                // The waiter may destroy the group once it sees released,
+                // so that store is the last touch, after the wake
+                woken_.store(waking, std::memory_order_release);
+                futex_wake(&woken_);
+                woken_.store(released, std::memory_order_release);
+            }
+        }
+    }
+
+    // Called once, by the fiber or thread that forked the children
+    void wait() {
+        scheduler* sched = scheduler::current();
+        if (sched != nullptr && sched->running() != nullptr) {
+            waiter_ = sched->running();
+            waiter_sched_ = sched;
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                sched->suspend();
+            }
+            return;
+        }
+
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            return;
+        }
+        while (woken_.load(std::memory_order_acquire) == idle) {
+            futex_wait(&woken_, idle);
+        }
+        // Woken: the last done() is at most one syscall from finishing
+        while (woken_.load(std::memory_order_acquire) != released) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+#endif // FIBERS_WAIT_GROUP_HPP
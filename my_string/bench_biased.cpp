@@ -0,0 +1,148 @@
+#include "my_string.hpp"
+#include "biased_count.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// RefCounted with atomic_count against biased_count (plain_count as the
+// single-threaded floor):
+//
+// 1. Owner-heavy: one thread copies and drops handles to objects it made.
+//    Biased counting stays on its plain local count.
+// 2. Cross-thread copies: several threads copy and drop handles to one
+//    object made elsewhere. Both policies use an atomic; biased pays an
+//    extra owner check.
+// 3. Hand-off: the owner copies objects and passes the copies to a consumer
+//    thread that drops them, so every object escapes and is merged through
+//    the owner's queue.
+
+constexpr size_t owner_copies = 20000000;
+constexpr size_t shared_copies = 2000000;
+constexpr size_t handoffs = 200000;
+constexpr int threads = 4;
+
+volatile long sink = 0;
+
+struct Record {
+    int id;
+    long bytes;
+};
+
+template<typename F>
+long long time_us(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// A few live objects, copied into and out of a small working set
+template<typename Count>
+long long owner_heavy() {
+    using ref = RefCounted<Record, Count>;
+    std::vector<ref> objects;
+    for (int i = 0; i < 16; i++) {
+        objects.emplace_back(std::in_place, Record{i, 0});
+    }
+    std::vector<ref> working(8, objects[0]);
+    return time_us([&] {
+        for (size_t i = 0; i < owner_copies; i++) {
+            working[i % 8] = objects[i % 16];
+            sink = sink + std::as_const(working[i % 8])->id;
+        }
+    });
+}
+
+template<typename Count>
+long long cross_thread() {
+    using ref = RefCounted<Record, Count>;
+    ref object(std::in_place, Record{1, 0});
+    return time_us([&] {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&object] {
+                long total = 0;
+                for (size_t i = 0; i < shared_copies; i++) {
+                    ref copy = object;
+                    total += std::as_const(copy)->id;
+                }
+                sink = sink + total;
+            });
+        }
+        for (std::thread& w : workers) {
+            w.join();
+        }
+    });
+}
+
+template<typename Count>
+long long hand_off() {
+    using ref = RefCounted<Record, Count>;
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<std::vector<ref>> batches;
+    bool done = false;
+
+    return time_us([&] {
+        std::thread consumer([&] {
+            for (;;) {
+                std::vector<ref> batch;
+                {
+                    std::unique_lock<std::mutex> hold(lock);
+                    ready.wait(hold, [&] { return done || !batches.empty(); });
+                    if (batches.empty()) {
+                        return;
+                    }
+                    batch = std::move(batches.front());
+                    batches.pop_front();
+                }
+                batch.clear();
+            }
+        });
+        std::vector<ref> batch;
+        for (size_t i = 0; i < handoffs; i++) {
+            ref object(std::in_place, Record{static_cast<int>(i), 0});
+            for (int c = 0; c < 4; c++) {
+                batch.push_back(object);
+            }
+            if (batch.size() == 256) {
+                std::lock_guard<std::mutex> hold(lock);
+                batches.push_back(std::move(batch));
+                batch.clear();
+                ready.notify_one();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> hold(lock);
+            batches.push_back(std::move(batch));
+            done = true;
+            ready.notify_one();
+        }
+        consumer.join();
+        if constexpr (deferred_release<Count>::value) {
+            Count::collect();
+        }
+    });
+}
+
+int main() {
+    std::cout << "Owner-heavy (" << owner_copies << " copy-assignments, one thread)\n";
+    std::cout << "plain_count:   " << owner_heavy<plain_count>() << " µs\n";
+    std::cout << "atomic_count:  " << owner_heavy<atomic_count>() << " µs\n";
+    std::cout << "biased_count:  " << owner_heavy<biased_count>() << " µs\n";
+
+    std::cout << "\nCross-thread copies (" << threads << " threads x " << shared_copies
+              << " copies of one object)\n";
+    std::cout << "atomic_count:  " << cross_thread<atomic_count>() << " µs\n";
+    std::cout << "biased_count:  " << cross_thread<biased_count>() << " µs\n";
+
+    std::cout << "\nHand-off (" << handoffs << " objects, 4 copies each dropped by a consumer)\n";
+    std::cout << "atomic_count:  " << hand_off<atomic_count>() << " µs\n";
+    std::cout << "biased_count:  " << hand_off<biased_count>() << " µs\n";
+    return 0;
+}
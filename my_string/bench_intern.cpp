@@ -0,0 +1,121 @@
+#include "intern_table.hpp"
+#include "my_string.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 1. Map lookups: a few thousand identifiers looked up over and over in an
+//    unordered_map keyed by interned handles and by std::string. The probe
+//    keys are separate copies of the map's keys, as they would be coming
+//    from elsewhere in a program.
+// 2. From text: turning raw text into a handle (hash, shared lock, probe),
+//    against looking my_string text up in the std::string map.
+// 3. Pre-population: interning every identifier into an empty table, with
+//    heap and arena storage.
+
+constexpr size_t identifiers = 4000;
+constexpr size_t lookups = 10000000;
+
+volatile size_t sink = 0;
+
+template<typename F>
+long long time_us(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Probe order that jumps around the key set
+size_t probe(size_t i) {
+    return (i * 2654435761u) % identifiers;
+}
+
+int main() {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < identifiers; i++) {
+        names.push_back("module_" + std::to_string(i % 37) + "::function_" + std::to_string(i));
+    }
+
+    intern_table table;
+    table.prepopulate(names.begin(), names.end());
+
+    std::unordered_map<interned, size_t> by_handle;
+    std::unordered_map<std::string, size_t> by_string;
+    for (size_t i = 0; i < identifiers; i++) {
+        by_handle[table.intern(names[i])] = i;
+        by_string[names[i]] = i;
+    }
+
+    std::vector<interned> handle_keys;
+    std::vector<std::string> string_keys;
+    for (size_t i = 0; i < identifiers; i++) {
+        handle_keys.push_back(table.intern(names[i]));
+        string_keys.push_back(std::string(names[i].c_str()));
+    }
+
+    long long handle_us = time_us([&] {
+        size_t total = 0;
+        for (size_t i = 0; i < lookups; i++) {
+            total += by_handle.find(handle_keys[probe(i)])->second;
+        }
+        sink = sink + total;
+    });
+    long long string_us = time_us([&] {
+        size_t total = 0;
+        for (size_t i = 0; i < lookups; i++) {
+            total += by_string.find(string_keys[probe(i)])->second;
+        }
+        sink = sink + total;
+    });
+
+    // Raw text to handle, the step a caller pays before using handles
+    long long intern_us = time_us([&] {
+        size_t total = 0;
+        for (size_t i = 0; i < lookups / 10; i++) {
+            total += table.intern(string_keys[probe(i)]).size();
+        }
+        sink = sink + total;
+    });
+    long long my_string_us = time_us([&] {
+        std::vector<local_string> texts;
+        for (size_t i = 0; i < identifiers; i++) {
+            texts.emplace_back(names[i].c_str());
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < lookups / 10; i++) {
+            total += by_string.find(texts[probe(i)].c_str())->second;
+        }
+        sink = sink + total;
+    });
+
+    long long heap_fill_us = time_us([&] {
+        for (int r = 0; r < 20; r++) {
+            intern_table fresh(intern_storage::heap);
+            fresh.prepopulate(names.begin(), names.end());
+            sink = sink + fresh.count();
+        }
+    });
+    long long arena_fill_us = time_us([&] {
+        for (int r = 0; r < 20; r++) {
+            intern_table fresh(intern_storage::arena);
+            fresh.prepopulate(names.begin(), names.end());
+            sink = sink + fresh.count();
+        }
+    });
+
+    std::cout << "Map lookups (" << identifiers << " identifiers, " << lookups << " lookups)\n";
+    std::cout << "interned keys:               " << handle_us << " µs\n";
+    std::cout << "std::string keys:            " << string_us << " µs\n";
+
+    std::cout << "\nFrom text (" << lookups / 10 << " lookups)\n";
+    std::cout << "intern_table::intern:        " << intern_us << " µs\n";
+    std::cout << "my_string -> std::string map: " << my_string_us << " µs\n";
+
+    std::cout << "\nPre-population (" << identifiers << " identifiers, 20 tables)\n";
+    std::cout << "heap storage:                " << heap_fill_us << " µs\n";
+    std::cout << "arena storage:               " << arena_fill_us << " µs\n";
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "string_kernels.hpp"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+// Time each string kernel against its libc equivalent on inputs of 16 B to
+// 64 KB, worst case: the character or needle sits at the very end, and
+// compared buffers are equal (for icompare, equal up to case), so every
+// byte is read. Prints nanoseconds per call, best of several runs.
+//
+//   find_char  memchr
+//   find       memmem (8-byte needle)
+//   equal      memcmp == 0
+//   compare    memcmp
+//   icompare   strncasecmp
+
+constexpr size_t sizes[] = {16, 64, 256, 1024, 4096, 16384, 65536};
+constexpr size_t bytes_per_run = 32 * 1024 * 1024;
+constexpr int runs = 5;
+
+volatile size_t sink = 0;
+
+// Best nanoseconds per call of f over several runs
+template<typename F>
+double time_ns(size_t size, F f) {
+    size_t calls = bytes_per_run / size;
+    double best = 1e300;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        size_t total = 0;
+        for (size_t i = 0; i < calls; i++) {
+            total += static_cast<size_t>(f());
+            __asm__ volatile("" ::: "memory");  // No hoisting libc calls out of the loop
+        }
+        auto end = std::chrono::steady_clock::now();
+        sink = sink + total;
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / calls;
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+struct row {
+    std::string name;
+    std::vector<double> ns;
+};
+
+void print(const std::vector<row>& rows) {
+    std::cout << std::left << std::setw(22) << "ns/call";
+    for (size_t size : sizes) {
+        std::cout << std::right << std::setw(10)
+                  << (size >= 1024 ? std::to_string(size / 1024) + "K" : std::to_string(size));
+    }
+    std::cout << "\n";
+    for (const row& r : rows) {
+        std::cout << std::left << std::setw(22) << r.name;
+        for (double ns : r.ns) {
+            std::cout << std::right << std::setw(10) << std::fixed << std::setprecision(1) << ns;
+        }
+        std::cout << "\n";
+    }
+}
+
+int main() {
+    using namespace string_kernels;
+    std::vector<const kernel_table*> tables = {&scalar_kernels()};
+#if defined(__x86_64__)
+    tables.push_back(&sse2_kernels());
+    if (avx2_supported()) {
+        tables.push_back(&avx2_kernels());
+    }
+#endif
+
+    const size_t largest = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    std::vector<char> text(largest), same(largest), upper(largest);
+    for (size_t i = 0; i < largest; i++) {
+        text[i] = same[i] = static_cast<char>('a' + i % 23);
+        upper[i] = static_cast<char>('A' + i % 23);
+    }
+    const char* needle = "XYZXYZX!";
+    const size_t needle_length = 8;
+
+    std::vector<row> rows;
+    auto measure = [&](const std::string& name, auto call) {
+        row r{name, {}};
+        for (size_t size : sizes) {
+            r.ns.push_back(time_ns(size, [&] { return call(size); }));
+        }
+        rows.push_back(r);
+    };
+
+    // Plant the search targets at the end of each size
+    auto at_end = [&](size_t size) {
+        std::vector<char> t(text.begin(), text.begin() + size);
+        t[size - 1] = '!';
+        memcpy(t.data() + size - needle_length, needle, needle_length);
+        return t;
+    };
+    std::vector<std::vector<char>> haystacks;
+    for (size_t size : sizes) {
+        haystacks.push_back(at_end(size));
+    }
+    auto haystack = [&](size_t size) {
+        for (size_t i = 0; i < haystacks.size(); i++) {
+            if (sizes[i] == size) return haystacks[i].data();
+        }
+        return haystacks.back().data();
+    };
+
+    measure("find_char memchr", [&](size_t n) {
+        return static_cast<const char*>(memchr(haystack(n), '!', n)) - haystack(n);
+    });
+    for (const kernel_table* k : tables) {
+        measure(std::string("find_char ") + k->name, [&](size_t n) {
+            return k->find_char(haystack(n), n, '!');
+        });
+    }
+    measure("find memmem", [&](size_t n) {
+        return static_cast<const char*>(memmem(haystack(n), n, needle, needle_length)) - haystack(n);
+    });
+    for (const kernel_table* k : tables) {
+        measure(std::string("find ") + k->name, [&](size_t n) {
+            return k->find(haystack(n), n, needle, needle_length);
+        });
+    }
+    measure("equal memcmp", [&](size_t n) { return memcmp(text.data(), same.data(), n) == 0; });
+    for (const kernel_table* k : tables) {
+        measure(std::string("equal ") + k->name, [&](size_t n) {
+            return k->equal(text.data(), same.data(), n);
+        });
+    }
+    measure("compare memcmp", [&](size_t n) { return memcmp(text.data(), same.data(), n); });
+    for (const kernel_table* k : tables) {
+        measure(std::string("compare ") + k->name, [&](size_t n) {
+            return k->compare(text.data(), n, same.data(), n);
+        });
+    }
+    measure("icompare strncasecmp", [&](size_t n) {
+        return strncasecmp(text.data(), upper.data(), n);
+    });
+    for (const kernel_table* k : tables) {
+        measure(std::string("icompare ") + k->name, [&](size_t n) {
+            return k->icompare(text.data(), n, upper.data(), n);
+        });
+    }
+
+    std::cout << "Dispatch picks: " << kernels().name << "\n\n";
+    print(rows);
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "my_string.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 1. Short keys: build keys of 8-20 characters, copy each twice and destroy
+//    everything. Compares small strings against the previous layout (every
+//    string heap-allocated and refcounted) and std::string.
+// 2. Copy-heavy: copy and drop long shared strings and RefCounted objects
+//    under each count/trace policy.
+// 3. Layout: build long strings and RefCounted objects into vectors that
+//    grow as they go, against the two-allocation, copy-only layout.
+//
+// my_string logs through std::cout, so the stream is disabled while timing;
+// the traced variants still pay for formatting the discarded output.
+
+constexpr size_t keys = 100000;
+constexpr int rounds = 5;
+constexpr size_t copies = 2000000;
+
+volatile size_t sink = 0;
+
+// my_string before small strings: a Data node and a char[] per string
+class heap_string {
+private:
+    struct Data {
+        char* str;
+        int ref_count;
+        Data(const char* s) : ref_count(1) {
+            str = new char[strlen(s) + 1];
+            strcpy(str, s);
+        }
+        ~Data() { delete[] str; }
+    };
+    Data* data;
+
+public:
+    heap_string(const char* s) : data(new Data(s)) {
+        std::cout << "[" << data->ref_count << "]" << std::endl;
+    }
+    heap_string(const heap_string& other) : data(other.data) {
+        data->ref_count++;
+        std::cout << "[" << data->ref_count << "]" << std::endl;
+    }
+    ~heap_string() {
+        data->ref_count--;
+        std::cout << "[" << data->ref_count << "]" << std::endl;
+        if (data->ref_count == 0) delete data;
+    }
+    heap_string& operator=(const heap_string&) = delete;
+    const char* c_str() const { return data->str; }
+};
+
+// The two-allocation, copy-only layout without logging, for section 3
+class legacy_string {
+private:
+    struct Data {
+        char* str;
+        int ref_count;
+        Data(const char* s) : ref_count(1) {
+            str = new char[strlen(s) + 1];
+            strcpy(str, s);
+        }
+        ~Data() { delete[] str; }
+    };
+    Data* data;
+
+public:
+    legacy_string(const char* s) : data(new Data(s)) {}
+    legacy_string(const legacy_string& other) : data(other.data) { data->ref_count++; }
+    ~legacy_string() {
+        if (--data->ref_count == 0) delete data;
+    }
+    legacy_string& operator=(const legacy_string&) = delete;
+    const char* c_str() const { return data->str; }
+};
+
+template<typename T>
+class legacy_ref {
+private:
+    struct Data {
+        T* obj;
+        int ref_count;
+        Data(const T& t) : obj(new T(t)), ref_count(1) {}
+        ~Data() { delete obj; }
+    };
+    Data* data;
+
+public:
+    legacy_ref(const T& t) : data(new Data(t)) {}
+    legacy_ref(const legacy_ref& other) : data(other.data) { data->ref_count++; }
+    ~legacy_ref() {
+        if (--data->ref_count == 0) delete data;
+    }
+    legacy_ref& operator=(const legacy_ref&) = delete;
+    const T* operator->() const { return data->obj; }
+};
+
+const char* c_str(const std::string& s) { return s.c_str(); }
+template<typename S>
+const char* c_str(const S& s) { return s.c_str(); }
+
+template<typename String>
+long long run(const std::vector<std::string>& input) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        std::vector<String> built;
+        built.reserve(input.size());
+        for (const std::string& key : input) {
+            built.emplace_back(key.c_str());
+        }
+        std::vector<String> copies;
+        copies.reserve(2 * built.size());
+        for (const String& s : built) {
+            copies.push_back(s);
+            copies.push_back(s);
+        }
+        sink = sink + static_cast<size_t>(c_str(copies.back())[0]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+struct Point {
+    int x, y;
+};
+
+// Keep a window of 64 live copies of one shared object, cycling through it
+template<typename Shared>
+long long copy_heavy(const Shared& original) {
+    std::vector<Shared> window(64, original);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < copies; i++) {
+        window[i % 64] = original;
+        Shared temporary(window[(i + 1) % 64]);
+        sink = sink + static_cast<size_t>(temporary.get_ref_count());
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Fill a vector without reserve(), so it reallocates as it grows
+template<typename Value, typename Make>
+long long grow(Make make) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        std::vector<Value> values;
+        for (size_t i = 0; i < keys; i++) {
+            values.push_back(make(i));
+        }
+        sink = sink + values.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    std::vector<std::string> input;
+    for (size_t i = 0; i < keys; i++) {
+        input.push_back("key:" + std::to_string(i * 7919) + std::string(i % 8, 'x'));
+    }
+
+    const char* text = "a long value that is shared between many owners";
+
+    std::cout.setstate(std::ios::badbit);
+    long long small_us = run<my_string>(input);
+    long long small_quiet_us = run<local_string>(input);
+    long long heap_us = run<heap_string>(input);
+    long long std_us = run<std::string>(input);
+
+    long long traced_us = copy_heavy(my_string(text));
+    long long plain_us = copy_heavy(local_string(text));
+    long long atomic_us = copy_heavy(shared_string(text));
+    long long ref_plain_us = copy_heavy(RefCounted<Point>(Point{1, 2}));
+    long long ref_atomic_us = copy_heavy(RefCounted<Point, atomic_count>(Point{1, 2}));
+    std::cout.clear();
+
+    long long one_alloc_us = grow<local_string>([&](size_t) { return local_string(text); });
+    long long two_alloc_us = grow<legacy_string>([&](size_t) { return legacy_string(text); });
+    long long ref_one_us = grow<RefCounted<Point>>([](size_t i) {
+        return RefCounted<Point>(std::in_place, Point{static_cast<int>(i), 0});
+    });
+    long long ref_two_us = grow<legacy_ref<Point>>([](size_t i) {
+        return legacy_ref<Point>(Point{static_cast<int>(i), 0});
+    });
+
+    std::cout << "Short keys (" << keys << " keys, built once and copied twice, "
+              << rounds << " rounds)\n";
+    std::cout << "my_string (inline, traced):  " << small_us << " µs\n";
+    std::cout << "local_string (inline):       " << small_quiet_us << " µs\n";
+    std::cout << "heap layout (traced):        " << heap_us << " µs\n";
+    std::cout << "std::string:                 " << std_us << " µs\n";
+
+    std::cout << "\nCopy-heavy (" << copies << " assign + copy + destroy)\n";
+    std::cout << "my_string (plain, traced):   " << traced_us << " µs\n";
+    std::cout << "local_string (plain):        " << plain_us << " µs\n";
+    std::cout << "shared_string (atomic):      " << atomic_us << " µs\n";
+    std::cout << "RefCounted<T> (plain):       " << ref_plain_us << " µs\n";
+    std::cout << "RefCounted<T> (atomic):      " << ref_atomic_us << " µs\n";
+
+    std::cout << "\nLayout (" << keys << " long strings / objects into a growing vector, "
+              << rounds << " rounds)\n";
+    std::cout << "local_string (1 alloc, moves): " << one_alloc_us << " µs\n";
+    std::cout << "two allocations, copies:       " << two_alloc_us << " µs\n";
+    std::cout << "RefCounted<T> (1 alloc, moves): " << ref_one_us << " µs\n";
+    std::cout << "two allocations, copies:       " << ref_two_us << " µs\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "my_string.hpp"
+#include "../allocator/arena_allocator.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Request simulation: each request parses a set of header lines into long
+// strings, copies some into a response and edits them (copy-on-write),
+// builds a few RefCounted records, then drops everything. Strings come
+// from the heap, from a per-request arena through arena_allocator (frees
+// of the newest block are handed back, the rest wait for the reset) or
+// through bulk_arena_allocator, which skips the final deallocate; the
+// arena is reset after every request.
+
+constexpr size_t requests = 200000;
+constexpr size_t headers = 32;
+
+volatile size_t sink = 0;
+
+struct Record {
+    int id;
+    long bytes;
+};
+
+using request_arena = arena<64 * 1024>;
+
+// Allocators for one request: how to make them from the arena, if any
+struct heap_policy {
+    using string_alloc = std::allocator<char>;
+    using record_alloc = std::allocator<Record>;
+    static string_alloc strings(request_arena&) { return {}; }
+    static record_alloc records(request_arena&) { return {}; }
+};
+
+template<template<typename, typename> class Alloc>
+struct arena_policy {
+    using string_alloc = Alloc<char, request_arena>;
+    using record_alloc = Alloc<Record, request_arena>;
+    static string_alloc strings(request_arena& a) { return string_alloc(a); }
+    static record_alloc records(request_arena& a) { return record_alloc(a); }
+};
+
+template<typename Policy>
+long long simulate(const std::vector<std::string>& lines, bool reset) {
+    using string_type = basic_my_string<plain_count, no_trace, typename Policy::string_alloc>;
+    using record_type = RefCounted<Record, plain_count, no_trace, typename Policy::record_alloc>;
+
+    request_arena arena;
+    std::vector<string_type> parsed;
+    std::vector<string_type> response;
+    std::vector<record_type> records;
+    parsed.reserve(headers);
+    response.reserve(headers);
+    records.reserve(headers);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < requests; r++) {
+        auto strings = Policy::strings(arena);
+        auto record_alloc = Policy::records(arena);
+        for (size_t h = 0; h < headers; h++) {
+            const std::string& line = lines[(r + h) % lines.size()];
+            parsed.emplace_back(line.c_str(), line.size(), strings);
+        }
+        for (size_t h = 0; h < headers; h += 2) {
+            response.push_back(parsed[h]);
+            response.back().setChar(0, 'X');
+        }
+        for (size_t h = 0; h < headers / 4; h++) {
+            records.emplace_back(std::allocator_arg, record_alloc, std::in_place,
+                                 Record{static_cast<int>(h), static_cast<long>(r)});
+        }
+        sink = sink + response.back().size() + records.size();
+        records.clear();
+        response.clear();
+        parsed.clear();
+        if (reset) {
+            arena.reset();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    std::vector<std::string> lines;
+    for (int i = 0; i < 100; i++) {
+        lines.push_back("X-Header-" + std::to_string(i) + ": " +
+                        std::string(24 + (i * 37) % 80, static_cast<char>('a' + i % 26)));
+    }
+
+    long long heap_us = simulate<heap_policy>(lines, false);
+    long long arena_us = simulate<arena_policy<arena_allocator>>(lines, true);
+    long long bulk_us = simulate<arena_policy<bulk_arena_allocator>>(lines, true);
+
+    std::cout << "Request simulation (" << requests << " requests, " << headers
+              << " header strings, " << headers / 2 << " copy-on-write edits, "
+              << headers / 4 << " records each)\n";
+    std::cout << "heap (std::allocator):       " << heap_us << " µs\n";
+    std::cout << "arena_allocator + reset:     " << arena_us << " µs\n";
+    std::cout << "bulk_arena_allocator + reset: " << bulk_us << " µs\n";
+    return 0;
+}
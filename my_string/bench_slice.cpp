@@ -0,0 +1,142 @@
+#include "my_slice.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 1. Tokenize: split a large refcounted buffer on spaces into zero-copy
+//    slices, into copied local_strings (the only option before slices) and
+//    into std::strings. Short tokens fit inline, so copying them is cheap;
+//    long tokens (24 to 88 characters) need an allocation each.
+// 2. Concatenate: join pieces back together through a rope flattened once
+//    at the end, against appending each piece to a std::string and
+//    building a local_string from the result. Many small tokens favour the
+//    contiguous append; a few large fragments favour the rope, which copies
+//    each byte once.
+
+constexpr size_t words = 500000;
+constexpr size_t fragments = 64;
+constexpr size_t fragment_size = 16 * 1024;
+constexpr int rounds = 10;
+
+volatile size_t sink = 0;
+
+template<typename F>
+long long time_us(F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Call emit(begin, length) for every space-separated token
+template<typename Emit>
+void split(const char* text, size_t length, Emit emit) {
+    size_t start = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i == length || text[i] == ' ') {
+            if (i > start) {
+                emit(start, i - start);
+            }
+            start = i + 1;
+        }
+    }
+}
+
+struct tokenize_times {
+    long long slice_us, copy_us, std_us;
+};
+
+tokenize_times tokenize(const local_string& buffer) {
+    const char* chars = buffer.c_str();
+    size_t length = strlen(chars);
+    tokenize_times t;
+    t.slice_us = time_us([&] {
+        std::vector<local_slice> tokens;
+        split(chars, length, [&](size_t pos, size_t n) { tokens.emplace_back(buffer, pos, n); });
+        sink = sink + tokens.size();
+    });
+    t.copy_us = time_us([&] {
+        std::vector<local_string> tokens;
+        split(chars, length, [&](size_t pos, size_t n) { tokens.emplace_back(chars + pos, n); });
+        sink = sink + tokens.size();
+    });
+    t.std_us = time_us([&] {
+        std::vector<std::string> tokens;
+        split(chars, length, [&](size_t pos, size_t n) { tokens.emplace_back(chars + pos, n); });
+        sink = sink + tokens.size();
+    });
+    return t;
+}
+
+struct join_times {
+    long long rope_us, copy_us;
+};
+
+join_times join(const std::vector<local_slice>& pieces, const local_string& separator) {
+    join_times t;
+    t.rope_us = time_us([&] {
+        local_rope joined;
+        for (const local_slice& piece : pieces) {
+            joined += piece;
+            joined += separator;
+        }
+        sink = sink + joined.to_string().c_str()[0];
+    });
+    t.copy_us = time_us([&] {
+        std::string joined;
+        for (const local_slice& piece : pieces) {
+            joined.append(piece.data(), piece.size());
+            joined += separator.c_str();
+        }
+        local_string result(joined.c_str(), joined.size());
+        sink = sink + result.c_str()[0];
+    });
+    return t;
+}
+
+int main() {
+    std::string short_text, long_text;
+    for (size_t i = 0; i < words; i++) {
+        std::string token = "token" + std::to_string(i * 7919 % 100000);
+        short_text += token + std::string(i % 12, 'x') + " ";
+        long_text += token + std::string(24 + i % 64, 'x') + " ";
+    }
+    local_string short_buffer(short_text.c_str());
+    local_string long_buffer(long_text.c_str());
+
+    tokenize_times short_tokens = tokenize(short_buffer);
+    tokenize_times long_tokens = tokenize(long_buffer);
+
+    std::vector<local_slice> tokens;
+    split(long_buffer.c_str(), long_text.size(), [&](size_t pos, size_t n) {
+        tokens.emplace_back(long_buffer, pos, n);
+    });
+    std::vector<local_slice> parts;
+    for (size_t i = 0; i < fragments; i++) {
+        parts.emplace_back(long_buffer, i * fragment_size, fragment_size);
+    }
+    local_string separator(", ");
+    join_times token_join = join(tokens, separator);
+    join_times fragment_join = join(parts, separator);
+
+    std::cout << "Tokenize (" << words << " tokens, " << rounds << " rounds)\n";
+    std::cout << "                        short      long\n";
+    std::cout << "local_slice (shared):   " << short_tokens.slice_us << " µs  "
+              << long_tokens.slice_us << " µs\n";
+    std::cout << "local_string (copied):  " << short_tokens.copy_us << " µs  "
+              << long_tokens.copy_us << " µs\n";
+    std::cout << "std::string (copied):   " << short_tokens.std_us << " µs  "
+              << long_tokens.std_us << " µs\n";
+
+    std::cout << "\nConcatenate (" << rounds << " rounds)\n";
+    std::cout << "                        " << tokens.size() << " tokens   "
+              << fragments << " x " << fragment_size / 1024 << " KB\n";
+    std::cout << "local_rope, flattened:  " << token_join.rope_us << " µs  "
+              << fragment_join.rope_us << " µs\n";
+    std::cout << "std::string + copy:     " << token_join.copy_us << " µs  "
+              << fragment_join.copy_us << " µs\n";
+    return 0;
+}
@@ -0,0 +1,254 @@
+#ifndef BIASED_COUNT_HPP
+#define BIASED_COUNT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Biased reference counting for RefCounted<T, biased_count>.
+//
+// Most copies of an object happen on the thread that created it, so that
+// thread (the owner) counts in a plain int, local, and every other thread
+// counts in an atomic, shared. The object is live while local + shared > 0.
+// shared can go negative, when a reference the owner counted is dropped on
+// another thread.
+//
+// The two counts are merged, after which everyone uses shared:
+//  - when the owner's local count reaches 0 (its releases are done), or
+//  - when the object escapes: another thread drops a reference and takes
+//    shared below 0. The owner's local count may then be all that is left,
+//    and only the owner may read it, so the object is queued to the owner,
+//    which merges it on its next release, in collect(), or when it exits.
+//    If the owner has already exited, the releasing thread merges itself.
+//
+// Shared holds count * 4 plus two flags, so count and flags change together.
+namespace biased_detail {
+
+struct counter;
+
+// One per thread that has created a biased object. Never freed, since
+// objects may outlive their owner thread and still look at it; all of them
+// stay on one list.
+struct owner {
+    std::atomic<bool> exited{false};
+    std::atomic<bool> pending{false};
+    std::mutex lock;
+    std::vector<counter*> queue;
+    owner* next = nullptr;
+};
+
+inline std::atomic<owner*>& all_owners() {
+    static std::atomic<owner*> head{nullptr};
+    return head;
+}
+
+inline owner*& current_owner() {
+    static thread_local owner* me = nullptr;
+    return me;
+}
+
+void collect(owner& me);
+
+// Drains the owner's queue when its thread exits. Exited is set under the
+// lock with the queue empty, so nothing is queued to a dead owner.
+struct exit_guard {
+    owner* me;
+    ~exit_guard() {
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> hold(me->lock);
+                if (me->queue.empty()) {
+                    me->exited.store(true, std::memory_order_release);
+                    return;
+                }
+            }
+            collect(*me);
+        }
+    }
+};
+
+inline owner& this_owner() {
+    owner*& me = current_owner();
+    if (me == nullptr) {
+        me = new owner();
+        me->next = all_owners().load(std::memory_order_relaxed);
+        while (!all_owners().compare_exchange_weak(me->next, me, std::memory_order_release)) {}
+        static thread_local exit_guard guard{me};
+        (void)guard;
+    }
+    return *me;
+}
+
+constexpr int64_t merged = 1;     // Everyone counts in shared now
+constexpr int64_t queued = 2;     // Sitting in the owner's queue
+constexpr int64_t one = 4;
+
+inline int64_t count_of(int64_t shared) { return shared >> 2; }   // Arithmetic shift
+
+struct counter {
+    owner* const creator;
+    int64_t local;                  // Owner thread only
+    bool owner_merged;              // Owner thread only
+    std::atomic<int64_t> shared;
+    void* object;
+    void (*destroy)(void*);
+
+    counter(int initial)
+        : creator(&this_owner()), local(initial), owner_merged(false), shared(0),
+          object(nullptr), destroy(nullptr) {}
+
+    // Reading only current_owner(), never creating one
+    bool owned_here() const {
+        return creator == current_owner() && !owner_merged;
+    }
+
+    // Fold local into shared and set merged, keeping queued. Returns the
+    // flags and count after the merge. Owner thread only.
+    int64_t merge() {
+        int64_t add = local;
+        local = 0;
+        owner_merged = true;
+        int64_t old = shared.load(std::memory_order_relaxed);
+        int64_t desired;
+        do {
+            desired = (count_of(old) + add) * one + (old & queued) + merged;
+        } while (!shared.compare_exchange_weak(old, desired, std::memory_order_acq_rel));
+        return desired;
+    }
+
+    // The same once the owner has exited, from whichever thread gets there
+    // first; nobody writes local any more. Returns true if this call merged
+    // and the count came to 0.
+    bool merge_orphan() {
+        int64_t old = shared.load(std::memory_order_relaxed);
+        int64_t desired;
+        do {
+            if (old & merged) {
+                return false;   // Another thread merged, our release included
+            }
+            desired = (count_of(old) + local) * one + merged;
+        } while (!shared.compare_exchange_weak(old, desired, std::memory_order_acq_rel));
+        return count_of(desired) == 0;
+    }
+
+    void reclaim() {
+        destroy(object);
+    }
+};
+
+// Merge every object other threads queued to this owner, freeing the ones
+// nobody references any more
+inline void collect(owner& me) {
+    if (!me.pending.exchange(false, std::memory_order_acquire)) {
+        return;
+    }
+    std::vector<counter*> objects;
+    {
+        std::lock_guard<std::mutex> hold(me.lock);
+        objects.swap(me.queue);
+    }
+    for (counter* c : objects) {
+        // Merge if an owner release has not already; whoever sees the count
+        // at 0 with queued clear frees, so clearing it hands that over
+        if (!c->owner_merged) {
+            c->merge();
+        }
+        int64_t old = c->shared.fetch_and(~queued, std::memory_order_acq_rel);
+        if (count_of(old) == 0) {
+            c->reclaim();
+        }
+    }
+}
+
+} // namespace biased_detail
+
+struct biased_count {
+    using type = biased_detail::counter;
+
+    // Told by RefCounted how to destroy the object when a deferred merge
+    // finds it unreferenced
+    static void bind(type& count, void* object, void (*destroy)(void*)) {
+        count.object = object;
+        count.destroy = destroy;
+    }
+
+    static int increment(type& count) {
+        if (count.owned_here()) {
+            return static_cast<int>(++count.local);
+        }
+        count.shared.fetch_add(biased_detail::one, std::memory_order_relaxed);
+        return 2;   // At least; the owner's count is not readable here
+    }
+
+    // Returns 0 when the caller holds the last reference and must destroy
+    static int decrement(type& count) {
+        using namespace biased_detail;
+        if (count.owned_here()) {
+            owner& me = *count.creator;
+            if (me.pending.load(std::memory_order_relaxed)) {
+                biased_detail::collect(me);
+            }
+            if (--count.local > 0) {
+                return static_cast<int>(count.local);
+            }
+            int64_t merged_count = count.merge();
+            if (merged_count & queued) {
+                return 1;   // The queue entry frees it
+            }
+            return static_cast<int>(count_of(merged_count));
+        }
+
+        int64_t old = count.shared.fetch_sub(one, std::memory_order_acq_rel);
+        int64_t remaining = count_of(old) - 1;
+        if (old & merged) {
+            return (old & queued) != 0 ? 1 : static_cast<int>(remaining);
+        }
+        owner& creator = *count.creator;
+        if (remaining < 0 && !(old & queued)) {
+            // Escaped: only the owner can tell whether this was the last one
+            std::lock_guard<std::mutex> hold(creator.lock);
+            if (!creator.exited.load(std::memory_order_relaxed)) {
+                // Another escaping release may have queued it since our
+                // fetch_sub; one queue entry per object, or collect() would
+                // free it and then touch it again
+                if (count.shared.fetch_or(queued, std::memory_order_relaxed) & queued) {
+                    return 1;
+                }
+                creator.queue.push_back(&count);
+                creator.pending.store(true, std::memory_order_release);
+                return 1;
+            }
+        }
+        if (creator.exited.load(std::memory_order_acquire)) {
+            // Nobody will collect it: merge here
+            return count.merge_orphan() ? 0 : 1;
+        }
+        return 1;
+    }
+
+    // Exact on the owner thread; elsewhere exact once merged, otherwise 2
+    // so copy-on-write copies rather than risk writing to a shared object
+    static int load(const type& count) {
+        int64_t shared = biased_detail::count_of(count.shared.load(std::memory_order_acquire));
+        if (count.owned_here()) {
+            return static_cast<int>(count.local + shared);
+        }
+        if (count.shared.load(std::memory_order_acquire) & biased_detail::merged) {
+            return static_cast<int>(shared);
+        }
+        return 2;
+    }
+
+    // Merge whatever other threads queued to the calling thread. Threads
+    // that hand biased objects to others and live long should call this at
+    // quiet points; it also runs on the thread's next owner release and
+    // when it exits.
+    static void collect() {
+        if (biased_detail::owner* me = biased_detail::current_owner()) {
+            biased_detail::collect(*me);
+        }
+    }
+};
+
+#endif // BIASED_COUNT_HPP
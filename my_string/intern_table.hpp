@@ -0,0 +1,338 @@
+#ifndef INTERN_TABLE_HPP
+#define INTERN_TABLE_HPP
+
+#include "../allocator/bump_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+namespace intern_detail {
+
+// Header of an interned string; the characters follow it, NUL-terminated.
+// Everything but the count is immutable once the node is published.
+struct node {
+    std::atomic<int> ref_count;
+    bool in_arena;      // Memory belongs to the table's arena, never freed alone
+    size_t hash;
+    size_t length;
+
+    node(size_t hash, size_t length, bool in_arena)
+        : ref_count(1), in_arena(in_arena), hash(hash), length(length) {}
+
+    char* str() { return reinterpret_cast<char*>(this + 1); }
+
+    static size_t bytes(size_t length) { return sizeof(node) + length + 1; }
+};
+
+// 64-bit FNV-1a
+inline size_t hash_text(std::string_view text) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : text) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return static_cast<size_t>(h);
+}
+
+} // namespace intern_detail
+
+// Handle to a canonical string in an intern_table. Two handles from the same
+// table are equal exactly when they point at the same node, and hash() reads
+// the hash stored at intern time, so a handle is a cheap key for hash maps.
+// Copies share the node through an atomic count. A default-constructed
+// handle is empty.
+class interned {
+private:
+    intern_detail::node* node_ = nullptr;
+
+    friend class intern_table;
+
+    // Adopts a reference the caller already holds
+    explicit interned(intern_detail::node* n) : node_(n) {}
+
+    // Takes a new reference
+    static interned share(intern_detail::node* n) {
+        n->ref_count.fetch_add(1, std::memory_order_relaxed);
+        return interned(n);
+    }
+
+    void release() {
+        if (node_ != nullptr &&
+            node_->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+            !node_->in_arena) {
+            node_->~node();
+            ::operator delete(node_);
+        }
+    }
+
+public:
+    interned() = default;
+
+    interned(const interned& other) : node_(other.node_) {
+        if (node_ != nullptr) {
+            node_->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    interned(interned&& other) noexcept : node_(other.node_) {
+        other.node_ = nullptr;
+    }
+
+    ~interned() { release(); }
+
+    interned& operator=(const interned& other) {
+        if (node_ != other.node_) {
+            interned copy(other);
+            std::swap(node_, copy.node_);
+        }
+        return *this;
+    }
+
+    interned& operator=(interned&& other) noexcept {
+        if (this != &other) {
+            release();
+            node_ = other.node_;
+            other.node_ = nullptr;
+        }
+        return *this;
+    }
+
+    bool operator==(const interned& other) const { return node_ == other.node_; }
+    bool operator!=(const interned& other) const { return node_ != other.node_; }
+
+    explicit operator bool() const { return node_ != nullptr; }
+
+    const char* c_str() const { return node_ == nullptr ? "" : node_->str(); }
+    size_t size() const { return node_ == nullptr ? 0 : node_->length; }
+    size_t hash() const { return node_ == nullptr ? 0 : node_->hash; }
+    std::string_view view() const { return std::string_view(c_str(), size()); }
+
+    // Includes the table's own reference; 0 when empty
+    int get_ref_count() const {
+        return node_ == nullptr ? 0 : node_->ref_count.load(std::memory_order_acquire);
+    }
+};
+
+namespace std {
+template<>
+struct hash<interned> {
+    size_t operator()(const interned& s) const noexcept { return s.hash(); }
+};
+}
+
+enum class intern_storage {
+    heap,   // One allocation per string; purge() frees unused strings
+    arena   // Strings are bump-allocated and freed with the table
+};
+
+// Concurrent table of canonical strings. intern() returns the one handle
+// for its text, adding it on first use. The table is split into shards by
+// hash; each shard is an open-addressing array behind a shared_mutex, so
+// lookups of strings already present only take a shared lock.
+//
+// With intern_storage::arena every shard bump-allocates its strings from
+// a chained arena: no per-string allocation, but the memory is only
+// returned when the table is destroyed, and handles must not outlive it.
+// With intern_storage::heap a handle keeps its string alive on its own.
+class intern_table {
+private:
+    static constexpr size_t shard_count = 16;
+
+    struct alignas(64) shard {
+        mutable std::shared_mutex lock;
+        std::vector<intern_detail::node*> slots;   // Power of two, or empty
+        size_t count = 0;
+        arena<16 * 1024> strings;
+    };
+
+    intern_storage storage_;
+    shard shards_[shard_count];
+
+    shard& shard_for(size_t hash) {
+        return shards_[(hash >> 32) % shard_count];
+    }
+
+    static intern_detail::node* find_in(const shard& s, std::string_view text, size_t hash) {
+        if (s.slots.empty()) {
+            return nullptr;
+        }
+        size_t mask = s.slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            intern_detail::node* n = s.slots[i];
+            if (n == nullptr) {
+                return nullptr;
+            }
+            if (n->hash == hash && n->length == text.size() &&
+                memcmp(n->str(), text.data(), text.size()) == 0) {
+                return n;
+            }
+        }
+    }
+
+    static void place(std::vector<intern_detail::node*>& slots, intern_detail::node* n) {
+        size_t mask = slots.size() - 1;
+        size_t i = n->hash & mask;
+        while (slots[i] != nullptr) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = n;
+    }
+
+    // Rebuild the slot array with room for at least `wanted` strings at a
+    // load factor of at most 1/2. Caller holds the exclusive lock.
+    static void rehash(shard& s, size_t wanted) {
+        size_t capacity = 16;
+        while (capacity < wanted * 2) {
+            capacity *= 2;
+        }
+        if (capacity <= s.slots.size()) {
+            return;
+        }
+        std::vector<intern_detail::node*> slots(capacity, nullptr);
+        for (intern_detail::node* n : s.slots) {
+            if (n != nullptr) {
+                place(slots, n);
+            }
+        }
+        s.slots.swap(slots);
+    }
+
+    intern_detail::node* create(shard& s, std::string_view text, size_t hash) {
+        size_t bytes = intern_detail::node::bytes(text.size());
+        bool in_arena = storage_ == intern_storage::arena;
+        void* memory = in_arena ? s.strings.allocate(bytes, alignof(intern_detail::node))
+                                : ::operator new(bytes);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        intern_detail::node* n = new (memory) intern_detail::node(hash, text.size(), in_arena);
+        memcpy(n->str(), text.data(), text.size());
+        n->str()[text.size()] = '\0';
+        return n;
+    }
+
+    // Drop the table's reference to a string it no longer lists
+    static void drop(intern_detail::node* n) {
+        interned adopted(n);    // Released on scope exit
+    }
+
+public:
+    explicit intern_table(intern_storage storage = intern_storage::heap)
+        : storage_(storage) {}
+
+    intern_table(const intern_table&) = delete;
+    intern_table& operator=(const intern_table&) = delete;
+
+    ~intern_table() {
+        for (shard& s : shards_) {
+            for (intern_detail::node* n : s.slots) {
+                if (n != nullptr) {
+                    drop(n);
+                }
+            }
+        }
+    }
+
+    // The canonical handle for text, added if not present. Any thread.
+    interned intern(std::string_view text) {
+        size_t hash = intern_detail::hash_text(text);
+        shard& s = shard_for(hash);
+        {
+            std::shared_lock<std::shared_mutex> read(s.lock);
+            if (intern_detail::node* n = find_in(s, text, hash)) {
+                return interned::share(n);
+            }
+        }
+        std::unique_lock<std::shared_mutex> write(s.lock);
+        if (intern_detail::node* n = find_in(s, text, hash)) {
+            return interned::share(n);      // Another thread won the race
+        }
+        if ((s.count + 1) * 2 > s.slots.size()) {
+            rehash(s, s.count + 1);
+        }
+        intern_detail::node* n = create(s, text, hash);
+        place(s.slots, n);
+        s.count++;
+        return interned::share(n);
+    }
+
+    // The handle for text if it has been interned, otherwise an empty handle
+    interned find(std::string_view text) const {
+        size_t hash = intern_detail::hash_text(text);
+        const shard& s = shards_[(hash >> 32) % shard_count];
+        std::shared_lock<std::shared_mutex> read(s.lock);
+        intern_detail::node* n = find_in(s, text, hash);
+        return n == nullptr ? interned() : interned::share(n);
+    }
+
+    // Intern every string in [first, last), typically at startup, so later
+    // lookups only take shared locks. Sizes each shard once up front.
+    template<typename It>
+    void prepopulate(It first, It last) {
+        size_t expected = static_cast<size_t>(std::distance(first, last));
+        reserve(count() + expected);
+        for (; first != last; ++first) {
+            intern(std::string_view(*first));
+        }
+    }
+
+    // Make room for about `strings` strings in total without rehashing
+    void reserve(size_t strings) {
+        size_t per_shard = strings / shard_count + 1;
+        for (shard& s : shards_) {
+            std::unique_lock<std::shared_mutex> write(s.lock);
+            rehash(s, per_shard + per_shard / 4);
+        }
+    }
+
+    // Remove strings no handle refers to and return how many went. Heap
+    // strings are freed; arena strings keep their bytes until destruction.
+    size_t purge() {
+        size_t removed = 0;
+        for (shard& s : shards_) {
+            std::unique_lock<std::shared_mutex> write(s.lock);
+            std::vector<intern_detail::node*> kept;
+            for (intern_detail::node* n : s.slots) {
+                if (n == nullptr) {
+                    continue;
+                }
+                // Only the table holds it, and new handles need this lock
+                if (n->ref_count.load(std::memory_order_acquire) == 1) {
+                    drop(n);
+                    removed++;
+                } else {
+                    kept.push_back(n);
+                }
+            }
+            std::fill(s.slots.begin(), s.slots.end(), nullptr);
+            for (intern_detail::node* n : kept) {
+                place(s.slots, n);
+            }
+            s.count = kept.size();
+        }
+        return removed;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (const shard& s : shards_) {
+            std::shared_lock<std::shared_mutex> read(s.lock);
+            total += s.count;
+        }
+        return total;
+    }
+
+    intern_storage storage() const { return storage_; }
+};
+
+#endif // INTERN_TABLE_HPP
@@ -0,0 +1,280 @@
+#ifndef MY_SLICE_HPP
+#define MY_SLICE_HPP
+
+#include "my_string.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Read-only view of part of a basic_my_string that keeps the characters
+// alive. A slice of a long string shares its reference-counted buffer and
+// stores an offset and a length, so taking one never allocates or copies;
+// setChar() on the parent copies first, since the slice holds a reference.
+// A slice of an inline string copies the few characters it covers.
+// Slices are not NUL-terminated: use data() with size(), or view().
+template<typename Count = plain_count, typename Trace = cout_trace,
+         typename Allocator = std::allocator<char>>
+class basic_my_slice {
+public:
+    using string_type = basic_my_string<Count, Trace, Allocator>;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    template<typename, typename, typename> friend class basic_my_rope;
+
+    using Data = typename string_type::Data;
+
+    union {
+        Data* buffer;                                       // Shared buffer
+        char small[string_type::inline_capacity + 1];       // Own copy
+    };
+    bool is_small;
+    size_t offset;
+    size_t length;
+
+    void share(const basic_my_slice& other) {
+        is_small = other.is_small;
+        offset = other.offset;
+        length = other.length;
+        if (is_small) {
+            memcpy(small, other.small, sizeof(small));
+        } else {
+            buffer = other.buffer;
+            Count::increment(buffer->ref_count);
+        }
+    }
+
+    void steal(basic_my_slice& other) noexcept {
+        is_small = other.is_small;
+        offset = other.offset;
+        length = other.length;
+        memcpy(small, other.small, sizeof(small));
+        other.is_small = true;
+        other.offset = other.length = 0;
+    }
+
+    int release() {
+        int remaining = Count::decrement(buffer->ref_count);
+        if (remaining == 0) {
+            Data::destroy(buffer);
+        }
+        return remaining;
+    }
+
+    // Characters of the whole buffer this slice looks into
+    char* base() { return is_small ? small : buffer->str(); }
+    const char* base() const { return is_small ? small : buffer->str(); }
+
+    // Slice of [pos, pos + count) of the characters at source. Clamps to
+    // the available characters like std::string::substr.
+    void init(const char* source, Data* shared, size_t available, size_t pos, size_t count) {
+        pos = pos < available ? pos : available;
+        count = count < available - pos ? count : available - pos;
+        length = count;
+        is_small = shared == nullptr;
+        if (is_small) {
+            memcpy(small, source + pos, count);
+            offset = 0;
+        } else {
+            buffer = shared;
+            Count::increment(buffer->ref_count);
+            offset = pos;
+        }
+        Trace::count(get_ref_count());
+    }
+
+public:
+    basic_my_slice() : is_small(true), offset(0), length(0) {}
+
+    // O(1) for long strings, whose length is kept in the buffer header:
+    // no allocation, no copy
+    basic_my_slice(const string_type& s, size_t pos = 0, size_t count = npos) {
+        if (s.is_small) {
+            init(s.small, nullptr, s.small_length, pos, count);
+        } else {
+            init(s.data->str(), s.data, s.data->length, pos, count);
+        }
+    }
+
+    basic_my_slice(const basic_my_slice& other) {
+        share(other);
+        Trace::count(get_ref_count());
+    }
+
+    basic_my_slice(basic_my_slice&& other) noexcept {
+        steal(other);
+        Trace::count(get_ref_count());
+    }
+
+    ~basic_my_slice() {
+        if (!is_small) {
+            Trace::count(release());
+        }
+    }
+
+    basic_my_slice& operator=(const basic_my_slice& other) {
+        if (this != &other) {
+            if (!is_small) {
+                release();
+            }
+            share(other);
+        }
+        return *this;
+    }
+
+    basic_my_slice& operator=(basic_my_slice&& other) noexcept {
+        if (this != &other) {
+            if (!is_small) {
+                release();
+            }
+            steal(other);
+        }
+        return *this;
+    }
+
+    // A slice of this slice, sharing the same buffer
+    basic_my_slice substr(size_t pos, size_t count = npos) const {
+        basic_my_slice result;
+        result.init(data(), is_small ? nullptr : buffer, length, pos, count);
+        return result;
+    }
+
+    // A string holding these characters. Shares the buffer when the slice
+    // covers a whole long string, otherwise copies.
+    string_type to_string() const {
+        if (!is_small && offset == 0 && length == buffer->length) {
+            return string_type(typename string_type::share_tag{}, buffer);
+        }
+        if (is_small) {
+            return string_type(typename string_type::inline_tag{}, data(), length);
+        }
+        return string_type(data(), length, Allocator(buffer->allocator()));     // Same place
+    }
+
+    const char* data() const { return base() + offset; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    char operator[](size_t index) const { return data()[index]; }
+    std::string_view view() const { return std::string_view(data(), length); }
+
+    int get_ref_count() const {
+        return is_small ? 1 : Count::load(buffer->ref_count);
+    }
+
+    bool is_inline() const {
+        return is_small;
+    }
+};
+
+// Concatenation of strings and slices that defers copying. append() only
+// records the pieces (each one a slice, so it keeps its buffer alive);
+// flatten() copies them into one buffer, and setChar() does so first when
+// there is more than one piece or the buffer is shared.
+template<typename Count = plain_count, typename Trace = cout_trace,
+         typename Allocator = std::allocator<char>>
+class basic_my_rope {
+public:
+    using string_type = basic_my_string<Count, Trace, Allocator>;
+    using slice_type = basic_my_slice<Count, Trace, Allocator>;
+
+private:
+    std::vector<slice_type> pieces;
+    size_t length = 0;
+    Allocator allocator;
+
+    // Copy every piece into one new buffer
+    string_type concatenate() const {
+        string_type flat(typename string_type::uninitialized_tag{}, length, allocator);
+        char* out = flat.raw();
+        for (const slice_type& piece : pieces) {
+            memcpy(out, piece.data(), piece.size());
+            out += piece.size();
+        }
+        return flat;
+    }
+
+public:
+    // Flattened buffers come from allocator
+    explicit basic_my_rope(const Allocator& allocator = Allocator()) : allocator(allocator) {}
+
+    basic_my_rope& append(const slice_type& piece) {
+        if (!piece.empty()) {
+            pieces.push_back(piece);
+            length += piece.size();
+        }
+        return *this;
+    }
+
+    basic_my_rope& append(const string_type& s) {
+        return append(slice_type(s));
+    }
+
+    basic_my_rope& append(const basic_my_rope& other) {
+        size_t count = other.pieces.size();     // other may be *this
+        pieces.reserve(pieces.size() + count);
+        for (size_t i = 0; i < count; i++) {
+            pieces.push_back(other.pieces[i]);
+        }
+        length += other.length;
+        return *this;
+    }
+
+    template<typename Piece>
+    basic_my_rope& operator+=(const Piece& piece) {
+        return append(piece);
+    }
+
+    // Copy the pieces into a single buffer; no-op if there is at most one
+    void flatten() {
+        if (pieces.size() > 1) {
+            slice_type whole(concatenate());
+            pieces.clear();
+            pieces.push_back(std::move(whole));
+        }
+    }
+
+    // The characters as one string; shares the buffer once flattened
+    string_type to_string() {
+        flatten();
+        return pieces.empty() ? string_type("", allocator) : pieces.front().to_string();
+    }
+
+    // Copy-on-write: flattens, and copies the buffer if anything shares it
+    void setChar(size_t index, char c) {
+        if (pieces.size() != 1 || pieces.front().get_ref_count() > 1) {
+            slice_type whole(concatenate());
+            pieces.clear();
+            pieces.push_back(std::move(whole));
+        }
+        slice_type& piece = pieces.front();
+        piece.base()[piece.offset + index] = c;
+    }
+
+    char operator[](size_t index) const {
+        for (const slice_type& piece : pieces) {
+            if (index < piece.size()) {
+                return piece[index];
+            }
+            index -= piece.size();
+        }
+        return '\0';
+    }
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    size_t piece_count() const { return pieces.size(); }
+};
+
+using my_slice = basic_my_slice<plain_count, cout_trace>;
+using local_slice = basic_my_slice<plain_count, no_trace>;
+using shared_slice = basic_my_slice<atomic_count, no_trace>;
+
+using my_rope = basic_my_rope<plain_count, cout_trace>;
+using local_rope = basic_my_rope<plain_count, no_trace>;
+using shared_rope = basic_my_rope<atomic_count, no_trace>;
+
+#endif // MY_SLICE_HPP
@@ -1,138 +1,524 @@
 #ifndef MY_STRING_HPP
 #define MY_STRING_HPP
 
+#include "string_kernels.hpp"
+
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Reference count policies. increment() and decrement() return the new count.
+
+// Plain int: for objects that never leave one thread
+struct plain_count {
+    using type = int;
+
+    static int increment(type& count) { return ++count; }
+    static int decrement(type& count) { return --count; }
+    static int load(const type& count) { return count; }
+};
+
+// Atomic count, safe to share across threads. Increments are relaxed (a new
+// reference is always made from an existing one); the decrement is acq_rel
+// so the thread that frees sees every other owner's writes.
+struct atomic_count {
+    using type = std::atomic<int>;
+
+    static int increment(type& count) {
+        return count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    static int decrement(type& count) {
+        return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+    static int load(const type& count) {
+        return count.load(std::memory_order_acquire);
+    }
+};
+
+// Policies whose last release may be finished later by another thread
+// (biased_count in biased_count.hpp) provide bind(), through which the
+// object tells them how to destroy it. Only RefCounted supports them.
+template<typename Count, typename = void>
+struct deferred_release : std::false_type {};
+
+template<typename Count>
+struct deferred_release<Count, std::void_t<decltype(&Count::bind)>> : std::true_type {};
+
+// Allocators that declare `using bulk_release = std::true_type` have their
+// memory reclaimed all at once, by resetting or rewinding an arena
+// (bulk_arena_allocator in allocator/arena_allocator.hpp). For them the
+// last release of a buffer skips the deallocate call, and also the
+// destructor when there is nothing to destroy.
+template<typename Allocator, typename = void>
+struct released_in_bulk : std::false_type {};
+
+template<typename Allocator>
+struct released_in_bulk<Allocator, std::void_t<typename Allocator::bulk_release>>
+    : Allocator::bulk_release {};
+
+// Tracing policies, called with the new count after every construction,
+// copy and destruction
+
+// Prints "[count]" like the original worksheet
+struct cout_trace {
+    static void count(int n) {
+        std::cout << "[" << n << "]" << std::endl;
+    }
+};
+
+// Compiles to nothing
+struct no_trace {
+    static void count(int) {}
+};
+
+template<typename Count, typename Trace, typename Allocator> class basic_my_slice;
+template<typename Count, typename Trace, typename Allocator> class basic_my_rope;
+
+// Reference-counted string with copy-on-write. Strings of up to
+// inline_capacity characters are stored inside the object itself (small
+// string optimization): they need no allocation, are copied by value and
+// always report a reference count of 1. Longer strings share one
+// reference-counted buffer until setChar() writes to it; the count, the
+// length and the characters share a single allocation, so size() is a load,
+// and searches and comparisons go to string_kernels.hpp. Moves never touch
+// the count and leave the source an empty string. basic_my_slice and
+// basic_my_rope (my_slice.hpp) share the same buffers.
+//
+// Count selects plain or atomic reference counts, Trace whether every
+// construction, copy and destruction is logged. Buffers come from
+// Allocator, a std Allocator such as arena_allocator<char, Arena>; the
+// buffer keeps a copy of it, so copy-on-write copies go to the same place.
+template<typename Count = plain_count, typename Trace = cout_trace,
+         typename Allocator = std::allocator<char>>
+class basic_my_string {
+    static_assert(!deferred_release<Count>::value, "basic_my_string needs a count released in place");
+
+public:
+    static constexpr size_t inline_capacity = 23;
+    static constexpr size_t npos = string_kernels::npos;
 
-class my_string {
 private:
-    struct Data {
-        char* str;
-        int ref_count;
-        
-        Data(const char* s) : ref_count(1) {
-            str = new char[strlen(s) + 1];
-            strcpy(str, s);
-        }
-        
-        ~Data() {
-            delete[] str;
+    template<typename, typename, typename> friend class basic_my_slice;
+    template<typename, typename, typename> friend class basic_my_rope;
+
+    struct Data;
+    using data_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Data>;
+    using data_traits = std::allocator_traits<data_allocator>;
+
+    // Header of a long string's buffer; the characters follow it. The
+    // allocator is an empty base when it has no state.
+    struct Data : private data_allocator {
+        typename Count::type ref_count;
+        size_t length;
+
+        Data(size_t length, const data_allocator& allocator)
+            : data_allocator(allocator), ref_count(1), length(length) {}
+
+        const data_allocator& allocator() const { return *this; }
+
+        char* str() { return reinterpret_cast<char*>(this + 1); }
+
+        // The buffer is allocated in units of Data, to keep its alignment
+        static size_t units(size_t length) {
+            return (sizeof(Data) + length + 1 + sizeof(Data) - 1) / sizeof(Data);
+        }
+
+        // Room for length characters, which the caller fills in
+        static Data* allocate(size_t length, const data_allocator& allocator) {
+            data_allocator a(allocator);
+            Data* d = new (data_traits::allocate(a, units(length))) Data(length, allocator);
+            d->str()[length] = '\0';
+            return d;
+        }
+
+        static Data* create(const char* s, size_t length, const data_allocator& allocator) {
+            Data* d = allocate(length, allocator);
+            memcpy(d->str(), s, length);
+            return d;
+        }
+
+        static void destroy(Data* d) {
+            if (released_in_bulk<Allocator>::value &&
+                std::is_trivially_destructible<data_allocator>::value) {
+                return;
+            }
+            data_allocator a(d->allocator());
+            size_t n = units(d->length);
+            d->~Data();
+            if (!released_in_bulk<Allocator>::value) {
+                data_traits::deallocate(a, d, n);
+            }
         }
     };
-    
-    Data* data;
-    
+
+    union {
+        Data* data;                             // Long strings
+        char small[inline_capacity + 1];        // Short strings, NUL-terminated
+    };
+    bool is_small;
+    unsigned char small_length;                 // Length of an inline string,
+                                                // 0 for long ones
+
+    // Drop one reference to a long string's buffer. The count is taken
+    // before the buffer can be freed, and nothing touches it afterwards.
+    static int drop(Data* d) {
+        int remaining = Count::decrement(d->ref_count);
+        if (remaining == 0) {
+            Data::destroy(d);
+        }
+        return remaining;
+    }
+
+    // Drop this object's reference to a long string's buffer
+    int release() {
+        return drop(data);
+    }
+
+    // Take other's contents and leave it an empty inline string
+    void steal(basic_my_string& other) noexcept {
+        is_small = other.is_small;
+        small_length = other.small_length;
+        memcpy(small, other.small, sizeof(small));  // Either layout
+        other.is_small = true;
+        other.small_length = 0;
+        other.small[0] = '\0';
+    }
+
+    // Share other's buffer, or copy its inline characters
+    void share(const basic_my_string& other) {
+        is_small = other.is_small;
+        small_length = other.small_length;
+        if (is_small) {
+            memcpy(small, other.small, sizeof(small));
+        } else {
+            data = other.data;
+            Count::increment(data->ref_count);
+        }
+    }
+
+    // An uninitialised string of length characters, for the slice and rope
+    // types to fill in
+    struct uninitialized_tag {};
+    basic_my_string(uninitialized_tag, size_t length, const Allocator& allocator) {
+        is_small = length <= inline_capacity;
+        if (is_small) {
+            small_length = static_cast<unsigned char>(length);
+            small[length] = '\0';
+        } else {
+            small_length = 0;
+            data = Data::allocate(length, data_allocator(allocator));
+        }
+        Trace::count(get_ref_count());
+    }
+
+    // A string of at most inline_capacity characters, which needs no allocator
+    struct inline_tag {};
+    basic_my_string(inline_tag, const char* s, size_t length)
+        : is_small(true), small_length(static_cast<unsigned char>(length)) {
+        memcpy(small, s, length);
+        small[length] = '\0';
+        Trace::count(1);
+    }
+
+    // Another reference to a long string's buffer
+    struct share_tag {};
+    basic_my_string(share_tag, Data* shared) : data(shared), is_small(false), small_length(0) {
+        Trace::count(Count::increment(data->ref_count));
+    }
+
+    char* raw() {
+        return is_small ? small : data->str();
+    }
+
 public:
-    my_string(const char* s) : data(new Data(s)) {
-        std::cout << "[" << data->ref_count << "]" << std::endl;
+    basic_my_string(const char* s, const Allocator& allocator = Allocator())
+        : basic_my_string(s, strlen(s), allocator) {}
+
+    // The first length characters of s, which need not be NUL-terminated
+    basic_my_string(const char* s, size_t length, const Allocator& allocator = Allocator()) {
+        is_small = length <= inline_capacity;
+        if (is_small) {
+            small_length = static_cast<unsigned char>(length);
+            memcpy(small, s, length);
+            small[length] = '\0';
+        } else {
+            small_length = 0;
+            data = Data::create(s, length, data_allocator(allocator));
+        }
+        Trace::count(get_ref_count());
     }
-    
-    my_string(const my_string& other) : data(other.data) {
-        data->ref_count++;
-        std::cout << "[" << data->ref_count << "]" << std::endl;
+
+    basic_my_string(const basic_my_string& other) {
+        share(other);
+        Trace::count(get_ref_count());
     }
-    
-    ~my_string() {
-        data->ref_count--;
-        std::cout << "[" << data->ref_count << "]" << std::endl;
-        if (data->ref_count == 0) {
-            delete data;
+
+    basic_my_string(basic_my_string&& other) noexcept {
+        steal(other);
+        Trace::count(get_ref_count());
+    }
+
+    ~basic_my_string() {
+        Trace::count(is_small ? 0 : release());
+    }
+
+    basic_my_string& operator=(const basic_my_string& other) {
+        if (this != &other) {
+            if (!is_small) {
+                release();
+            }
+            share(other);
         }
+        return *this;
     }
-    
-    my_string& operator=(const my_string& other) {
+
+    basic_my_string& operator=(basic_my_string&& other) noexcept {
         if (this != &other) {
-            data->ref_count--;
-            if (data->ref_count == 0) {
-                delete data;
+            if (!is_small) {
+                release();
             }
-            data = other.data;
-            data->ref_count++;
+            steal(other);
         }
         return *this;
     }
-    
+
     void setChar(int index, char c) {
-        if (data->ref_count > 1) {
-            // Copy-on-write: create a new copy if shared
-            Data* new_data = new Data(data->str);
-            data->ref_count--;
-            data = new_data;
+        if (is_small) {
+            small[index] = c;   // Never shared
+            return;
+        }
+        if (Count::load(data->ref_count) > 1) {
+            // Copy-on-write: switch to a private copy, then let go of the
+            // shared buffer
+            Data* shared = data;
+            data = Data::create(shared->str(), shared->length, shared->allocator());
+            drop(shared);
+        }
+        data->str()[index] = c;
+    }
+
+    const char* c_str() const {
+        return is_small ? small : data->str();
+    }
+
+    // Stored, not scanned for
+    size_t size() const {
+        return is_small ? small_length : data->length;
+    }
+
+    // Position of the first c or needle at or after pos, or npos. These and
+    // the comparisons run on the widest string_kernels the CPU supports.
+    size_t find(char c, size_t pos = 0) const {
+        if (pos >= size()) {
+            return npos;
+        }
+        size_t at = string_kernels::kernels().find_char(c_str() + pos, size() - pos, c);
+        return at == npos ? npos : pos + at;
+    }
+
+    size_t find(const char* needle, size_t pos = 0) const {
+        return find(needle, strlen(needle), pos);
+    }
+
+    size_t find(const basic_my_string& needle, size_t pos = 0) const {
+        return find(needle.c_str(), needle.size(), pos);
+    }
+
+    size_t find(const char* needle, size_t needle_length, size_t pos) const {
+        if (pos > size()) {
+            return npos;
         }
-        data->str[index] = c;
+        size_t at = string_kernels::kernels().find(c_str() + pos, size() - pos,
+                                                   needle, needle_length);
+        return at == npos ? npos : pos + at;
     }
-    
+
+    // <0, 0 or >0, ordering bytes as unsigned char
+    int compare(const basic_my_string& other) const {
+        return string_kernels::kernels().compare(c_str(), size(), other.c_str(), other.size());
+    }
+
+    // compare() with ASCII letters folded to lower case
+    int icompare(const basic_my_string& other) const {
+        return string_kernels::kernels().icompare(c_str(), size(), other.c_str(), other.size());
+    }
+
+    bool iequals(const basic_my_string& other) const {
+        return size() == other.size() && icompare(other) == 0;
+    }
+
+    bool operator==(const basic_my_string& other) const {
+        if (!is_small && !other.is_small && data == other.data) {
+            return true;    // Same buffer
+        }
+        return size() == other.size() &&
+               string_kernels::kernels().equal(c_str(), other.c_str(), size());
+    }
+
+    bool operator!=(const basic_my_string& other) const {
+        return !(*this == other);
+    }
+
     void print() const {
-        std::cout << data->str << std::endl;
+        std::cout << c_str() << std::endl;
     }
-    
+
     int get_ref_count() const {
-        return data->ref_count;
+        return is_small ? 1 : Count::load(data->ref_count);
+    }
+
+    // True if the characters live inside the object
+    bool is_inline() const {
+        return is_small;
     }
 };
 
-// Template wrapper for reference counting
-template<typename T>
+// The worksheet string: single-threaded and logged
+using my_string = basic_my_string<plain_count, cout_trace>;
+
+// Hot-path variants without logging
+using local_string = basic_my_string<plain_count, no_trace>;
+using shared_string = basic_my_string<atomic_count, no_trace>;
+
+// Template wrapper for reference counting. The count and the T live in one
+// allocation from Allocator, like std::allocate_shared; copy-on-write
+// copies use the same allocator. A moved-from RefCounted is empty: it may
+// only be destroyed or assigned to, and reports a count of 0.
+template<typename T, typename Count = plain_count, typename Trace = no_trace,
+         typename Allocator = std::allocator<T>>
 class RefCounted {
 private:
-    struct Data {
-        T* obj;
-        int ref_count;
-        
-        Data(const T& t) : ref_count(1) {
-            obj = new T(t);
+    struct Data;
+    using data_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Data>;
+    using data_traits = std::allocator_traits<data_allocator>;
+
+    struct Data : private data_allocator {
+        typename Count::type ref_count;
+        T obj;
+
+        template<typename... Args>
+        explicit Data(const data_allocator& allocator, Args&&... args)
+            : data_allocator(allocator), ref_count(1), obj(std::forward<Args>(args)...) {
+            if constexpr (deferred_release<Count>::value) {
+                Count::bind(ref_count, this, [](void* d) { destroy(static_cast<Data*>(d)); });
+            }
         }
-        
-        ~Data() {
-            delete obj;
+
+        const data_allocator& allocator() const { return *this; }
+
+        template<typename... Args>
+        static Data* create(const data_allocator& allocator, Args&&... args) {
+            data_allocator a(allocator);
+            Data* d = data_traits::allocate(a, 1);
+            try {
+                return new (d) Data(allocator, std::forward<Args>(args)...);
+            } catch (...) {
+                data_traits::deallocate(a, d, 1);
+                throw;
+            }
+        }
+
+        static void destroy(Data* d) {
+            if (released_in_bulk<Allocator>::value && std::is_trivially_destructible<Data>::value) {
+                return;
+            }
+            data_allocator a(d->allocator());
+            d->~Data();
+            if (!released_in_bulk<Allocator>::value) {
+                data_traits::deallocate(a, d, 1);
+            }
         }
     };
-    
+
     Data* data;
-    
+
+    // Drop one reference to d; see basic_my_string::drop()
+    static int drop(Data* d) {
+        int remaining = Count::decrement(d->ref_count);
+        if (remaining == 0) {
+            Data::destroy(d);
+        }
+        return remaining;
+    }
+
+    int release() {
+        return data == nullptr ? 0 : drop(data);
+    }
+
 public:
-    RefCounted(const T& t) : data(new Data(t)) {}
-    
+    RefCounted(const T& t, const Allocator& allocator = Allocator())
+        : data(Data::create(data_allocator(allocator), t)) {
+        Trace::count(1);
+    }
+
+    // Construct the T in place from args
+    template<typename... Args>
+    explicit RefCounted(std::in_place_t, Args&&... args)
+        : data(Data::create(data_allocator(Allocator()), std::forward<Args>(args)...)) {
+        Trace::count(1);
+    }
+
+    // The same, with its storage from allocator
+    template<typename... Args>
+    RefCounted(std::allocator_arg_t, const Allocator& allocator, std::in_place_t, Args&&... args)
+        : data(Data::create(data_allocator(allocator), std::forward<Args>(args)...)) {
+        Trace::count(1);
+    }
+
     RefCounted(const RefCounted& other) : data(other.data) {
-        data->ref_count++;
+        Trace::count(Count::increment(data->ref_count));
     }
-    
+
+    RefCounted(RefCounted&& other) noexcept : data(other.data) {
+        other.data = nullptr;
+    }
+
     ~RefCounted() {
-        data->ref_count--;
-        if (data->ref_count == 0) {
-            delete data;
+        if (data != nullptr) {
+            Trace::count(release());
         }
     }
-    
+
     RefCounted& operator=(const RefCounted& other) {
         if (this != &other) {
-            data->ref_count--;
-            if (data->ref_count == 0) {
-                delete data;
-            }
+            Count::increment(other.data->ref_count);
+            release();
             data = other.data;
-            data->ref_count++;
         }
         return *this;
     }
-    
+
+    RefCounted& operator=(RefCounted&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            other.data = nullptr;
+        }
+        return *this;
+    }
+
     T* operator->() {
-        if (data->ref_count > 1) {
+        if (Count::load(data->ref_count) > 1) {
             // Copy-on-write
-            Data* new_data = new Data(*data->obj);
-            data->ref_count--;
-            data = new_data;
+            Data* shared = data;
+            data = Data::create(shared->allocator(), shared->obj);
+            drop(shared);
         }
-        return data->obj;
+        return &data->obj;
     }
-    
+
     const T* operator->() const {
-        return data->obj;
+        return &data->obj;
     }
-    
+
     int get_ref_count() const {
-        return data->ref_count;
+        return data == nullptr ? 0 : Count::load(data->ref_count);
     }
 };
 
-#endif // MY_STRING_HPP 
\ No newline at end of file
+#endif // MY_STRING_HPP
@@ -0,0 +1,244 @@
+#ifndef STRING_KERNELS_HPP
+#define STRING_KERNELS_HPP
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// Search and comparison kernels over (pointer, length) ranges, in a scalar
+// version and, on x86_64, SSE2 and AVX2 versions. All of them return the
+// same results; kernels() picks the widest one the CPU and OS support, once,
+// from CPUID. The AVX2 kernels are compiled for that target on their own,
+// so the rest of the program needs no -mavx2.
+//
+// Case-insensitive kernels fold ASCII letters only. compare() and
+// icompare() order bytes as unsigned char, then shorter before longer.
+namespace string_kernels {
+
+constexpr size_t npos = static_cast<size_t>(-1);
+
+struct kernel_table {
+    const char* name;
+    size_t (*find_char)(const char* text, size_t length, char c);
+    size_t (*find)(const char* text, size_t length, const char* needle, size_t needle_length);
+    bool (*equal)(const char* a, const char* b, size_t length);
+    int (*compare)(const char* a, size_t a_length, const char* b, size_t b_length);
+    int (*icompare)(const char* a, size_t a_length, const char* b, size_t b_length);
+};
+
+namespace detail {
+
+inline unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+inline int order(size_t a_length, size_t b_length) {
+    return a_length < b_length ? -1 : a_length > b_length ? 1 : 0;
+}
+
+// Scalar versions: the reference the others are tested against, and the
+// tails of the SSE2 loops
+namespace scalar {
+
+inline size_t find_char(const char* text, size_t length, char c) {
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == c) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+inline size_t find(const char* text, size_t length, const char* needle, size_t needle_length) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (needle_length > length) {
+        return npos;
+    }
+    for (size_t i = 0; i <= length - needle_length; i++) {
+        if (text[i] == needle[0] && memcmp(text + i + 1, needle + 1, needle_length - 1) == 0) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+inline bool equal(const char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// compare<false> is compare(), compare<true> is icompare()
+template<bool Fold>
+int compare(const char* a, size_t a_length, const char* b, size_t b_length) {
+    size_t length = a_length < b_length ? a_length : b_length;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char x = a[i], y = b[i];
+        if (Fold) {
+            x = fold(x);
+            y = fold(y);
+        }
+        if (x != y) {
+            return x < y ? -1 : 1;
+        }
+    }
+    return order(a_length, b_length);
+}
+
+} // namespace scalar
+
+#if defined(__x86_64__)
+
+// The vector kernels are written once, in string_kernels_loops.hpp, over a
+// traits type V, and included once per instruction set inside a region that
+// compiles everything in it for that target. Each set finishes the bytes
+// left over after its last full vector with the next narrower one.
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+namespace sse2 {
+
+namespace narrow = scalar;
+
+struct V {
+    using vector = __m128i;
+    static constexpr size_t width = 16;
+    static constexpr unsigned all = 0xFFFF;
+
+    static vector load(const char* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    static vector splat(char c) { return _mm_set1_epi8(c); }
+    static unsigned eq(vector a, vector b) {
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    }
+    // ASCII letters to lower case: set 0x20 where (x - 'A') <= 25 unsigned
+    static vector lower(vector x) {
+        vector offset = _mm_sub_epi8(x, _mm_set1_epi8('A'));
+        vector upper = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(25)), offset);
+        return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
+};
+
+#include "string_kernels_loops.hpp"
+
+} // namespace sse2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+
+namespace narrow = sse2;
+
+struct V {
+    using vector = __m256i;
+    static constexpr size_t width = 32;
+    static constexpr unsigned all = 0xFFFFFFFFu;
+
+    static vector load(const char* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static vector splat(char c) { return _mm256_set1_epi8(c); }
+    static unsigned eq(vector a, vector b) {
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    }
+    static vector lower(vector x) {
+        vector offset = _mm256_sub_epi8(x, _mm256_set1_epi8('A'));
+        vector upper = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(25)), offset);
+        return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    }
+};
+
+#include "string_kernels_loops.hpp"
+
+} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+// AVX2 needs the CPU flag and the OS saving the YMM registers (OSXSAVE,
+// then XCR0 bits 1 and 2)
+inline bool cpu_has_avx2() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+        return false;
+    }
+    unsigned xcr0_low, xcr0_high;
+    __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    if ((xcr0_low & 0x6) != 0x6) {
+        return false;
+    }
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+}
+
+#endif // __x86_64__
+
+} // namespace detail
+
+inline const kernel_table& scalar_kernels() {
+    static const kernel_table table = {
+        "scalar", detail::scalar::find_char, detail::scalar::find, detail::scalar::equal,
+        detail::scalar::compare<false>, detail::scalar::compare<true>};
+    return table;
+}
+
+#if defined(__x86_64__)
+// SSE2 is part of x86_64, so these are always usable
+inline const kernel_table& sse2_kernels() {
+    static const kernel_table table = {
+        "sse2", detail::sse2::find_char, detail::sse2::find, detail::sse2::equal,
+        detail::sse2::compare<false>, detail::sse2::compare<true>};
+    return table;
+}
+
+// Only call through this table when avx2_supported()
+inline const kernel_table& avx2_kernels() {
+    static const kernel_table table = {
+        "avx2", detail::avx2::find_char, detail::avx2::find, detail::avx2::equal,
+        detail::avx2::compare<false>, detail::avx2::compare<true>};
+    return table;
+}
+
+inline bool avx2_supported() {
+    static const bool supported = detail::cpu_has_avx2();
+    return supported;
+}
+#endif
+
+// The widest kernels this machine runs, chosen on first use
+inline const kernel_table& kernels() {
+#if defined(__x86_64__)
+    static const kernel_table& best = avx2_supported() ? avx2_kernels() : sse2_kernels();
+#else
+    static const kernel_table& best = scalar_kernels();
+#endif
+    return best;
+}
+
+} // namespace string_kernels
+
+#endif // STRING_KERNELS_HPP
@@ -0,0 +1,84 @@
+// Vector kernels over the traits type V: load, splat, eq (a lane mask),
+// lower (ASCII fold), width and all (the mask with every lane set). The
+// namespace narrow holds the kernels that finish the tail.
+//
+// No include guard: string_kernels.hpp includes this once per instruction
+// set, inside a namespace that defines V and a region compiled for it.
+
+inline size_t find_char(const char* text, size_t length, char c) {
+    typename V::vector target = V::splat(c);
+    size_t i = 0;
+    for (; i + V::width <= length; i += V::width) {
+        if (unsigned mask = V::eq(V::load(text + i), target)) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    size_t rest = narrow::find_char(text + i, length - i, c);
+    return rest == npos ? npos : i + rest;
+}
+
+// Compare the needle's first and last characters at every position of a
+// block at once, and only memcmp the candidates where both match
+inline size_t find(const char* text, size_t length, const char* needle, size_t needle_length) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (needle_length > length) {
+        return npos;
+    }
+    if (needle_length == 1) {
+        return find_char(text, length, needle[0]);
+    }
+    typename V::vector first = V::splat(needle[0]);
+    typename V::vector last = V::splat(needle[needle_length - 1]);
+    size_t i = 0;
+    for (; i + needle_length - 1 + V::width <= length; i += V::width) {
+        unsigned mask = V::eq(V::load(text + i), first) &
+                        V::eq(V::load(text + i + needle_length - 1), last);
+        while (mask != 0) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if (memcmp(text + candidate + 1, needle + 1, needle_length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = narrow::find(text + i, length - i, needle, needle_length);
+    return rest == npos ? npos : i + rest;
+}
+
+inline bool equal(const char* a, const char* b, size_t length) {
+    size_t i = 0;
+    for (; i + V::width <= length; i += V::width) {
+        if (V::eq(V::load(a + i), V::load(b + i)) != V::all) {
+            return false;
+        }
+    }
+    return narrow::equal(a + i, b + i, length - i);
+}
+
+// compare<false> is compare(), compare<true> is icompare()
+template<bool Fold>
+int compare(const char* a, size_t a_length, const char* b, size_t b_length) {
+    size_t length = a_length < b_length ? a_length : b_length;
+    size_t i = 0;
+    for (; i + V::width <= length; i += V::width) {
+        typename V::vector x = V::load(a + i), y = V::load(b + i);
+        if (Fold) {
+            x = V::lower(x);
+            y = V::lower(y);
+        }
+        unsigned differ = ~V::eq(x, y) & V::all;
+        if (differ != 0) {
+            size_t at = i + __builtin_ctz(differ);
+            unsigned char p = a[at], q = b[at];
+            if (Fold) {
+                p = fold(p);
+                q = fold(q);
+            }
+            return p < q ? -1 : 1;
+        }
+    }
+    int rest = narrow::compare<Fold>(a + i, length - i, b + i, length - i);
+    return rest != 0 ? rest : order(a_length, b_length);
+}
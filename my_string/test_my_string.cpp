@@ -1,5 +1,60 @@
 #include "my_string.hpp"
+#include "../allocator/arena_allocator.hpp"
+#include "biased_count.hpp"
+#include "intern_table.hpp"
+#include "my_slice.hpp"
+#include "string_kernels.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Simple test framework
+#define ASSERT(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << #condition << std::endl; \
+            std::cerr << "  at " << __FILE__ << ":" << __LINE__ << std::endl; \
+            exit(1); \
+        } \
+    } while (0)
+
+// Counts every global allocation, to check layouts (atomic: some tests
+// allocate on several threads). Every plain, array and sized form is
+// replaced so news and deletes always pair up, and the frees stay out of
+// line: inlined into a caller, GCC would see free() on operator new memory.
+std::atomic<size_t> allocations{0};
+
+void* counted_allocate(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void counted_release(void* p) noexcept {
+    std::free(p);
+}
+
+void* operator new(size_t size) { return counted_allocate(size); }
+void* operator new[](size_t size) { return counted_allocate(size); }
+void operator delete(void* p) noexcept { counted_release(p); }
+void operator delete[](void* p) noexcept { counted_release(p); }
+void operator delete(void* p, size_t) noexcept { counted_release(p); }
+void operator delete[](void* p, size_t) noexcept { counted_release(p); }
 
 // Test class for RefCounted template
 class Point {
@@ -53,9 +108,494 @@ void test_template_wrapper() {
     std::cout << "Final ref count: " << p1.get_ref_count() << std::endl;
 }
 
+void test_small_strings() {
+    std::cout << "\n=== Test 4.4: Small String Optimization ===\n";
+    // Up to inline_capacity characters live in the object, unshared
+    my_string key("user:1234");
+    ASSERT(key.is_inline());
+    {
+        my_string copy = key;
+        ASSERT(copy.is_inline() && copy.get_ref_count() == 1);
+        copy.setChar(0, 'U');
+        ASSERT(strcmp(copy.c_str(), "User:1234") == 0);
+        ASSERT(strcmp(key.c_str(), "user:1234") == 0);
+    }
+
+    // Longer strings still share a buffer and copy on write
+    my_string boundary("abcdefghijklmnopqrstuvw");     // 23 characters
+    ASSERT(boundary.is_inline());
+    my_string over("abcdefghijklmnopqrstuvwx");        // 24 characters
+    ASSERT(!over.is_inline());
+
+    my_string a("a string that is too long to be stored inline");
+    my_string b = a;
+    ASSERT(!a.is_inline() && a.get_ref_count() == 2);
+    b.setChar(0, 'A');
+    ASSERT(a.get_ref_count() == 1 && b.get_ref_count() == 1);
+    ASSERT(a.c_str()[0] == 'a' && b.c_str()[0] == 'A');
+
+    // Assignment across both layouts
+    b = key;
+    ASSERT(b.is_inline() && strcmp(b.c_str(), "user:1234") == 0);
+    key = a;
+    ASSERT(!key.is_inline() && a.get_ref_count() == 2);
+    std::cout << "Small string test passed\n";
+}
+
+// Trace policy that records instead of printing
+std::vector<int> traced;
+struct record_trace {
+    static void count(int n) { traced.push_back(n); }
+};
+
+void test_policies() {
+    std::cout << "\n=== Test 4.5: Count and Trace Policies ===\n";
+    {
+        using traced_string = basic_my_string<plain_count, record_trace>;
+        traced_string a("a string that is too long to be stored inline");
+        traced_string b = a;
+        (void)b;
+    }
+    ASSERT((traced == std::vector<int>{1, 2, 1, 0}));
+
+    // Atomic counts survive copies racing on several threads
+    shared_string text("shared between every worker thread in the pool");
+    RefCounted<Point, atomic_count> point(Point(1, 2));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&text, &point] {
+            for (int i = 0; i < 10000; i++) {
+                shared_string copy = text;
+                RefCounted<Point, atomic_count> p = point;
+                ASSERT(copy.c_str()[0] == 's' && p->x == 1);
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    ASSERT(text.get_ref_count() == 1 && point.get_ref_count() == 1);
+
+    // Copy-on-write still applies
+    shared_string other = text;
+    other.setChar(0, 'S');
+    ASSERT(text.c_str()[0] == 's' && text.get_ref_count() == 1);
+    std::cout << "Policy test passed\n";
+}
+
+void test_layout_and_moves() {
+    std::cout << "\n=== Test 4.6: Single Allocation and Moves ===\n";
+    // Header and characters, or header and T, come from one allocation
+    size_t before = allocations;
+    local_string text("a string that is too long to be stored inline");
+    ASSERT(allocations == before + 1);
+    before = allocations;
+    RefCounted<Point> point(std::in_place, 3, 4);
+    ASSERT(allocations == before + 1 && point->y == 4);
+
+    // Moves hand the buffer over without touching the count
+    local_string moved(std::move(text));
+    ASSERT(moved.get_ref_count() == 1 && text.is_inline() && text.c_str()[0] == '\0');
+    text = std::move(moved);
+    ASSERT(text.get_ref_count() == 1 && moved.c_str()[0] == '\0');
+
+    RefCounted<Point> other(std::move(point));
+    ASSERT(other.get_ref_count() == 1 && point.get_ref_count() == 0);
+    point = std::move(other);
+    ASSERT(point->x == 3 && other.get_ref_count() == 0);
+
+    // Vector growth moves elements, so shared counts never change
+    local_string copy = text;
+    std::vector<local_string> strings;
+    for (int i = 0; i < 100; i++) {
+        strings.push_back(copy);
+    }
+    ASSERT(text.get_ref_count() == 102);
+    strings.clear();
+    ASSERT(text.get_ref_count() == 2);
+    static_assert(std::is_nothrow_move_constructible<local_string>::value, "");
+    static_assert(std::is_nothrow_move_constructible<RefCounted<Point>>::value, "");
+    std::cout << "Layout and move test passed\n";
+}
+
+void test_interning() {
+    std::cout << "\n=== Test 4.7: Interned Strings ===\n";
+    for (intern_storage storage : {intern_storage::heap, intern_storage::arena}) {
+        intern_table table(storage);
+        local_string key("a key that is long enough to live on the heap");
+        interned a = table.intern(key.c_str());
+        interned b = table.intern(std::string("a key that is long enough to live on the heap"));
+        interned c = table.intern("another key");
+        ASSERT(a == b && a != c && a.c_str() != key.c_str());
+        ASSERT(a.hash() == std::hash<interned>()(b) && a.size() == strlen(key.c_str()));
+        ASSERT(strcmp(c.c_str(), "another key") == 0 && table.count() == 2);
+        ASSERT(a.get_ref_count() == 3);     // a, b and the table
+        ASSERT(table.find("another key") == c && !table.find("missing"));
+
+        // Handles work as hash map keys
+        std::unordered_map<interned, int> values;
+        values[a] = 1;
+        values[c] = 2;
+        ASSERT(values[b] == 1 && values.size() == 2);
+        values.clear();
+
+        // Bulk population; existing strings keep their handles
+        std::vector<std::string> words;
+        for (int i = 0; i < 1000; i++) {
+            words.push_back("word" + std::to_string(i));
+        }
+        words.push_back("another key");
+        table.prepopulate(words.begin(), words.end());
+        ASSERT(table.count() == 1002 && table.intern("another key") == c);
+        ASSERT(strcmp(table.find("word999").c_str(), "word999") == 0);
+
+        // Only strings without outside handles are purged
+        b = interned();
+        ASSERT(table.purge() == 1000 && table.count() == 2);
+        ASSERT(table.find("word1").size() == 0 && table.intern("another key") == c);
+    }
+
+    // A heap string outlives its table while a handle holds it
+    interned survivor;
+    {
+        intern_table table;
+        survivor = table.intern("survivor");
+    }
+    ASSERT(strcmp(survivor.c_str(), "survivor") == 0 && survivor.get_ref_count() == 1);
+
+    // Threads interning the same words all get the same handles
+    intern_table shared;
+    std::vector<std::vector<interned>> seen(4);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&shared, &seen, t] {
+            for (int i = 0; i < 2000; i++) {
+                seen[t].push_back(shared.intern("name" + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    ASSERT(shared.count() == 2000);
+    for (int t = 1; t < 4; t++) {
+        ASSERT(seen[t] == seen[0]);
+    }
+    std::cout << "Interning test passed\n";
+}
+
+void test_slices_and_ropes() {
+    std::cout << "\n=== Test 4.8: Slices and Ropes ===\n";
+    local_string line("alpha,beta,gamma,a token list long enough for the heap");
+
+    // Slicing a long string shares its buffer without allocating
+    size_t before = allocations;
+    local_slice whole(line);
+    local_slice beta(line, 6, 4);
+    local_slice tail = whole.substr(17);
+    ASSERT(allocations == before);
+    ASSERT(beta.view() == "beta" && tail.view() == "a token list long enough for the heap");
+    ASSERT(!beta.is_inline() && line.get_ref_count() == 4);
+    ASSERT(local_slice(line, 1000).empty() && local_slice(line, 50, 1000).view() == "heap");
+
+    // Writing to the parent copies it; the slices keep the old text
+    line.setChar(6, 'B');
+    ASSERT(beta.view() == "beta" && line.c_str()[6] == 'B' && beta.get_ref_count() == 3);
+
+    // A slice covering a whole string converts back without copying
+    before = allocations;
+    local_string again = whole.to_string();
+    ASSERT(allocations == before && again.c_str() == whole.data());
+    ASSERT(strcmp(beta.to_string().c_str(), "beta") == 0);
+
+    // Slices of inline strings hold their own copy
+    local_string word("inline");
+    local_slice in(word, 2);
+    ASSERT(in.is_inline() && in.view() == "line" && in.substr(1, 2).view() == "in");
+
+    // Ropes record pieces until flattened
+    local_rope rope;
+    rope += whole;
+    rope += local_string(" / ");
+    rope += beta;
+    ASSERT(rope.piece_count() == 3 && rope.size() == whole.size() + 3 + 4);
+    ASSERT(rope[whole.size() + 1] == '/' && rope[rope.size() - 1] == 'a');
+    rope.append(rope);
+    ASSERT(rope.piece_count() == 6 && rope.size() == 2 * (whole.size() + 7));
+    local_string flat = rope.to_string();
+    ASSERT(rope.piece_count() == 1 && flat.get_ref_count() == 2);
+    ASSERT(strncmp(flat.c_str(), "alpha,beta,gamma", 16) == 0 && strlen(flat.c_str()) == rope.size());
+
+    // setChar copies a rope whose buffer is shared, and writes in place once not
+    rope.setChar(0, 'A');
+    ASSERT(flat.c_str()[0] == 'a' && rope.to_string().c_str()[0] == 'A');
+    local_rope single;
+    single += beta;
+    single.setChar(0, 'X');
+    ASSERT(beta.view() == "beta" && single.to_string().c_str()[0] == 'X');
+    std::cout << "Slice and rope test passed\n";
+}
+
+int sign(int x) {
+    return (x > 0) - (x < 0);
+}
+
+void test_kernels() {
+    std::cout << "\n=== Test 4.9: Search and Compare Kernels ===\n";
+    using namespace string_kernels;
+    std::vector<const kernel_table*> tables;
+#if defined(__x86_64__)
+    tables.push_back(&sse2_kernels());
+    if (avx2_supported()) {
+        tables.push_back(&avx2_kernels());
+    }
+#endif
+    const kernel_table& scalar = scalar_kernels();
+
+    // Random texts over a small alphabet, so matches and case-only
+    // differences are common, at every length up to a few vectors and
+    // every alignment; each kernel must agree with the scalar version
+    std::mt19937 random(42);
+    const char alphabet[] = "abcABC\x80\xff";
+    std::vector<char> a_buffer(400), b_buffer(400);
+    for (int round = 0; round < 20000; round++) {
+        size_t length = random() % 300;
+        size_t a_offset = random() % 32, b_offset = random() % 32;
+        char* a = a_buffer.data() + a_offset;
+        char* b = b_buffer.data() + b_offset;
+        for (size_t i = 0; i < length; i++) {
+            a[i] = alphabet[random() % 8];
+        }
+        memcpy(b, a, length);
+        if (length > 0 && random() % 2 == 0) {
+            b[random() % length] = alphabet[random() % 8];     // Maybe differs
+        }
+        size_t b_length = random() % 4 == 0 ? random() % (length + 1) : length;
+        char c = alphabet[random() % 8];
+
+        // Needles are usually taken from the text, sometimes random
+        size_t needle_length = random() % 8;
+        const char* needle = b;
+        if (random() % 4 != 0 && length > needle_length) {
+            needle = a + random() % (length - needle_length + 1);
+        } else if (needle_length > length) {
+            needle_length = length;
+        }
+
+        for (const kernel_table* k : tables) {
+            ASSERT(k->find_char(a, length, c) == scalar.find_char(a, length, c));
+            ASSERT(k->find(a, length, needle, needle_length) ==
+                   scalar.find(a, length, needle, needle_length));
+            ASSERT(k->equal(a, b, length) == scalar.equal(a, b, length));
+            ASSERT(sign(k->compare(a, length, b, b_length)) ==
+                   sign(scalar.compare(a, length, b, b_length)));
+            ASSERT(sign(k->icompare(a, length, b, b_length)) ==
+                   sign(scalar.icompare(a, length, b, b_length)));
+        }
+    }
+    ASSERT(scalar.compare("a\xff", 2, "a\x01", 2) > 0);   // Unsigned bytes
+    ASSERT(scalar.icompare("Hello", 5, "hELLO", 5) == 0);
+
+    // The string API on top of them
+    local_string text("The quick brown fox jumps over the lazy dog, twice over");
+    local_string small("quick");
+    ASSERT(text.size() == 55 && small.size() == 5 && local_string("").size() == 0);
+    ASSERT(text.find('q') == 4 && text.find('o', 13) == 17 && text.find('#') == local_string::npos);
+    ASSERT(text.find("over") == 26 && text.find("over", 27) == 51 && text.find(small) == 4);
+    ASSERT(text.find("") == 0 && text.find("dogs") == local_string::npos);
+    local_string copy = text;
+    local_string same("The quick brown fox jumps over the lazy dog, twice over");
+    ASSERT(copy == text && same == text && text != small && !(small == local_string("quicK")));
+    ASSERT(small.compare(local_string("quicker")) < 0 && text.compare(small) < 0);
+    ASSERT(small.iequals(local_string("QUICK")) && small.icompare(local_string("QUICKER")) < 0);
+    std::cout << "Kernel test passed (" << kernels().name << ")\n";
+}
+
+// Counts destructor calls, to see which releases run them
+struct Tracked {
+    static int destroyed;
+    int value;
+    explicit Tracked(int v) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) {}
+    ~Tracked() { destroyed++; }
+};
+int Tracked::destroyed = 0;
+
+void test_arena_strings() {
+    std::cout << "\n=== Test 4.10: Arena-Allocated Strings ===\n";
+    using arena_type = bump<4096>;
+    using arena_string = basic_my_string<plain_count, no_trace, arena_allocator<char, arena_type>>;
+    using bulk_string = basic_my_string<plain_count, no_trace, bulk_arena_allocator<char, arena_type>>;
+    const char* text = "a string that is too long to be stored inline";
+
+    arena_type arena;
+    arena_allocator<char, arena_type> in_arena(arena);
+    size_t before = allocations;
+    {
+        // get_allocation_count() is the arena's live allocations
+        arena_string a(text, in_arena);
+        ASSERT(arena.get_allocation_count() == 1 && arena.get_current_pos() > strlen(text));
+        arena_string b = a;
+        b.setChar(0, 'A');                  // The copy goes to the same arena
+        ASSERT(arena.get_allocation_count() == 2 && a.c_str()[0] == 'a' && b.c_str()[0] == 'A');
+        size_t used = arena.get_current_pos();
+        {
+            arena_string newest("another string that does not fit inline", in_arena);
+            ASSERT(arena.get_current_pos() > used);
+        }
+        ASSERT(arena.get_current_pos() == used);   // The newest block was handed back
+        arena_string small("short", in_arena);
+        ASSERT(small.is_inline() && arena.get_allocation_count() == 2);
+        ASSERT(allocations == before);      // Nothing came from the heap
+
+        // Slices and ropes keep to the arena
+        basic_my_slice<plain_count, no_trace, arena_allocator<char, arena_type>> part(a, 2, 30);
+        ASSERT(part.to_string().size() == 30 && arena.get_allocation_count() == 3);
+        basic_my_rope<plain_count, no_trace, arena_allocator<char, arena_type>> rope(in_arena);
+        rope += a;
+        rope += b;
+        ASSERT(rope.to_string().size() == 2 * a.size() && arena.get_allocation_count() == 3);
+    }
+    ASSERT(arena.get_allocation_count() == 0 && arena.get_current_pos() == 0);
+
+    // Bulk release: the last reference deallocates nothing, the arena
+    // reset reclaims it all
+    bulk_arena_allocator<char, arena_type> bulk(arena);
+    {
+        bulk_string a(text, bulk);
+        bulk_string b = a;
+        ASSERT(a.get_ref_count() == 2);
+    }
+    ASSERT(arena.get_allocation_count() == 1 && arena.get_current_pos() > 0);
+    arena.reset();
+    before = allocations;
+
+    // RefCounted with an allocator; destructors with an effect still run
+    using arena_ref = RefCounted<Tracked, plain_count, no_trace, arena_allocator<Tracked, arena_type>>;
+    using bulk_ref = RefCounted<Tracked, plain_count, no_trace, bulk_arena_allocator<Tracked, arena_type>>;
+    {
+        arena_ref p(std::allocator_arg, arena_allocator<Tracked, arena_type>(arena), std::in_place, 7);
+        arena_ref q = p;
+        ASSERT(q->value == 7 && arena.get_allocation_count() == 2);   // Copy-on-write
+        bulk_ref r(Tracked(8), bulk_arena_allocator<Tracked, arena_type>(arena));
+        ASSERT(r->value == 8);
+        Tracked::destroyed = 0;
+    }
+    ASSERT(Tracked::destroyed == 3 && allocations == before);
+    std::cout << "Arena string test passed\n";
+}
+
+void test_biased_count() {
+    std::cout << "\n=== Test 4.11: Biased Reference Counting ===\n";
+    using biased = RefCounted<Tracked, biased_count>;
+    Tracked::destroyed = 0;
+
+    // On the owner thread the count is exact and the last release frees
+    {
+        biased p(std::in_place, 1);
+        biased q = p;
+        std::vector<biased> more(3, q);
+        ASSERT(p.get_ref_count() == 5);
+        more.clear();
+        ASSERT(q.get_ref_count() == 2 && std::as_const(q)->value == 1);
+    }
+    ASSERT(Tracked::destroyed == 1);
+
+    // Owner copies released elsewhere queue the object to the owner, which
+    // merges and frees it in collect()
+    {
+        std::optional<biased> p(std::in_place, std::in_place, 2);
+        std::vector<biased> copies(4, *p);
+        p.reset();
+        std::thread([moved = std::move(copies)]() mutable { moved.clear(); }).join();
+        ASSERT(Tracked::destroyed == 1);
+        biased_count::collect();
+        ASSERT(Tracked::destroyed == 2);
+    }
+
+    // Once the owner's releases are done the counts merge, and the last
+    // release on another thread frees
+    {
+        std::optional<biased> p(std::in_place, std::in_place, 3);
+        std::vector<biased> held;
+        std::thread([&] { held.push_back(*p); }).join();
+        p.reset();
+        ASSERT(Tracked::destroyed == 2 && held[0].get_ref_count() == 1);
+        std::thread([&] { held.clear(); }).join();
+        ASSERT(Tracked::destroyed == 3);
+    }
+
+    // Objects outlive their owner thread
+    {
+        std::vector<biased> p;
+        std::thread([&] { p.emplace_back(std::in_place, 4); }).join();
+        std::optional<biased> q(p[0]);
+        q.reset();
+        ASSERT(Tracked::destroyed == 3);
+        p.clear();
+        ASSERT(Tracked::destroyed == 4);
+    }
+
+    // Copies on several threads at once
+    {
+        biased p(std::in_place, 5);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&p] {
+                for (int i = 0; i < 10000; i++) {
+                    biased a = p;
+                    biased b = a;
+                    ASSERT(std::as_const(b)->value == 5);
+                }
+            });
+        }
+        for (int i = 0; i < 10000; i++) {
+            biased a = p;
+        }
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        ASSERT(p.get_ref_count() == 1 && Tracked::destroyed == 4);
+    }
+    ASSERT(Tracked::destroyed == 5);
+
+    // Two threads drop owner-counted copies at once: both escape, and the
+    // object must be queued, merged and freed exactly once. Holding the
+    // owner's lock lets both releases count down before either queues.
+    constexpr int rounds = 200;
+    for (int r = 0; r < rounds; r++) {
+        std::optional<biased> a(std::in_place, std::in_place, 6);
+        std::optional<biased> b = a;
+        std::atomic<int> ready{0};
+        auto drop = [&ready](std::optional<biased>& copy) {
+            ready.fetch_add(1);
+            copy.reset();
+        };
+        std::thread first, second;
+        {
+            std::lock_guard<std::mutex> hold(biased_detail::this_owner().lock);
+            first = std::thread(drop, std::ref(a));
+            second = std::thread(drop, std::ref(b));
+            while (ready.load() < 2) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        first.join();
+        second.join();
+        biased_count::collect();
+    }
+    ASSERT(Tracked::destroyed == 5 + rounds);
+    std::cout << "Biased count test passed\n";
+}
+
 int main() {
     test_my_string();
     test_ref_count_zero();
     test_template_wrapper();
+    test_small_strings();
+    test_policies();
+    test_layout_and_moves();
+    test_interning();
+    test_slices_and_ropes();
+    test_kernels();
+    test_arena_strings();
+    test_biased_count();
     return 0;
 } 
\ No newline at end of file
@@ -6,6 +6,16 @@
 #include <vector>
 #include <functional>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 
 class TestFixture {
 public:
@@ -20,28 +30,20 @@ public:
         std::string value;
     };
 
-    static std::vector<TestResult> current_test_results;
-    static std::string current_test_name;
+    // Checks made outside TestRunner, reported by ExecuteTestGroup
+    static inline std::vector<TestResult> current_test_results;
+    static inline std::string current_test_name;
+
+    // Checks of the test TestRunner is running on this thread
+    static inline thread_local std::vector<TestResult>* running_test_results = nullptr;
 
     static bool ExecuteTestGroup(const char* group, Verbosity verbosity = Verbose) {
         std::cout << "\n=== Running test group: " << group << " ===\n" << std::endl;
         bool all_passed = true;
-        
+
         for (const auto& result : current_test_results) {
             if (verbosity == Verbose) {
-                std::cout << std::setw(50) << std::left << result.message;
-                if (result.passed) {
-                    std::cout << "\033[32m[PASSED]\033[0m";
-                    if (!result.value.empty()) {
-                        std::cout << " Value: " << result.value;
-                    }
-                } else {
-                    std::cout << "\033[31m[FAILED]\033[0m";
-                    if (!result.value.empty()) {
-                        std::cout << " Expected different value. Got: " << result.value;
-                    }
-                }
-                std::cout << std::endl;
+                PrintResult(result);
             }
             all_passed &= result.passed;
         }
@@ -52,22 +54,510 @@ public:
                                  [](const TestResult& r) { return r.passed; });
         std::cout << "Passed: " << passed << std::endl;
         std::cout << "Failed: " << (current_test_results.size() - passed) << std::endl;
-        
+
         current_test_results.clear();
         return all_passed;
     }
 
     static void AddTestResult(const std::string& message, bool passed, const std::string& value = "") {
-        current_test_results.push_back({message, passed, value});
+        if (running_test_results != nullptr) {
+            running_test_results->push_back({message, passed, value});
+        } else {
+            current_test_results.push_back({message, passed, value});
+        }
+    }
+
+    static void PrintResult(const TestResult& result) {
+        std::cout << std::setw(50) << std::left << result.message;
+        if (result.passed) {
+            std::cout << "\033[32m[PASSED]\033[0m";
+            if (!result.value.empty()) {
+                std::cout << " Value: " << result.value;
+            }
+        } else {
+            std::cout << "\033[31m[FAILED]\033[0m";
+            if (!result.value.empty()) {
+                std::cout << " Expected different value. Got: " << result.value;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // a == e, comparing integers by value whatever their signedness
+    template<typename A, typename E>
+    static bool Equal(const A& a, const E& e) {
+        if constexpr (std::is_integral_v<A> && std::is_integral_v<E> &&
+                      std::is_signed_v<A> != std::is_signed_v<E>) {
+            if constexpr (std::is_signed_v<A>) {
+                return a >= 0 && static_cast<std::make_unsigned_t<A>>(a) == e;
+            } else {
+                return e >= 0 && a == static_cast<std::make_unsigned_t<E>>(e);
+            }
+        } else {
+            return a == e;
+        }
+    }
+
+    // Keep a benchmark's result alive and opaque to the optimizer
+    template<typename T>
+    static void DoNotOptimize(T& value) {
+        asm volatile("" : "+r,m"(value) : : "memory");
     }
 };
 
-std::vector<TestFixture::TestResult> TestFixture::current_test_results;
-std::string TestFixture::current_test_name;
+// Tests and benchmarks register themselves here before main runs
+class TestRegistry {
+public:
+    struct TestCase {
+        const char* group;
+        const char* name;
+        void (*function)();
+        const char* file;
+        int line;
+        bool benchmark;
+
+        std::string FullName() const {
+            return std::string(group) + "." + name;
+        }
+    };
+
+    struct Registrar {
+        explicit Registrar(const TestCase& test) {
+            Cases().push_back(test);
+        }
+    };
+
+    // In registration order: file by file, top to bottom
+    static std::vector<TestCase>& Cases() {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+};
+
+// Runs every registered test that matches the filter, spread over a pool of
+// threads, then the matching benchmarks one at a time. Each test's checks
+// and time are kept separately and reported in registration order, as text
+// and optionally as JUnit XML and JSON.
+//
+// usage: <program> [--filter PATTERNS] [--threads N] [--junit FILE]
+//                  [--json FILE] [--bench] [--samples N] [--warmup N]
+//                  [--list] [--quiet]
+//
+// PATTERNS are ':'-separated globs (* and ?) over "group.name"; a leading
+// '-' excludes. --bench also runs benchmarks, which only run on their own.
+class TestRunner {
+public:
+    struct Options {
+        std::vector<std::string> filters;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        std::string junit_path;
+        std::string json_path;
+        bool benchmarks = false;
+        size_t samples = 50;        // Timed samples per benchmark
+        size_t warmup = 10;         // Untimed samples first
+        bool list = false;
+        TestFixture::Verbosity verbosity = TestFixture::Verbose;
+    };
+
+    struct CaseResult {
+        const TestRegistry::TestCase* test;
+        std::vector<TestFixture::TestResult> checks;
+        std::string error;          // Uncaught exception
+        bool passed = true;
+        double seconds = 0;
+    };
+
+    // Per call, over the samples
+    struct BenchResult {
+        const TestRegistry::TestCase* test;
+        size_t iterations = 0;      // Calls per sample
+        size_t samples = 0;
+        double min_ns = 0;
+        double median_ns = 0;
+        double p90_ns = 0;
+        double p99_ns = 0;
+        double max_ns = 0;
+    };
+
+    static int Run(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string flag = argv[i];
+            bool has_value = i + 1 < argc;
+            if (flag == "--filter" && has_value) {
+                options.filters = Split(argv[++i], ':');
+            } else if (flag == "--threads" && has_value) {
+                options.threads = static_cast<unsigned>(std::max(1ul, std::stoul(argv[++i])));
+            } else if (flag == "--junit" && has_value) {
+                options.junit_path = argv[++i];
+            } else if (flag == "--json" && has_value) {
+                options.json_path = argv[++i];
+            } else if (flag == "--samples" && has_value) {
+                options.samples = std::max(1ul, std::stoul(argv[++i]));
+            } else if (flag == "--warmup" && has_value) {
+                options.warmup = std::stoul(argv[++i]);
+            } else if (flag == "--bench") {
+                options.benchmarks = true;
+            } else if (flag == "--list") {
+                options.list = true;
+            } else if (flag == "--quiet") {
+                options.verbosity = TestFixture::Quiet;
+            } else {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        return Run(options);
+    }
+
+    static int Run(const Options& options) {
+        std::vector<const TestRegistry::TestCase*> tests, benchmarks;
+        for (const TestRegistry::TestCase& test : TestRegistry::Cases()) {
+            if (!Matches(test.FullName(), options.filters)) {
+                continue;
+            }
+            if (test.benchmark) {
+                if (options.benchmarks) {
+                    benchmarks.push_back(&test);
+                }
+            } else {
+                tests.push_back(&test);
+            }
+        }
+        if (options.list) {
+            for (const auto* test : tests) std::cout << test->FullName() << "\n";
+            for (const auto* test : benchmarks) std::cout << test->FullName() << " (benchmark)\n";
+            return 0;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<CaseResult> results = RunTests(tests, options.threads);
+        double seconds = SecondsSince(start);
+        size_t failed = std::count_if(results.begin(), results.end(),
+                                      [](const CaseResult& r) { return !r.passed; });
+        Report(results, options.verbosity);
+        std::cout << "\n" << results.size() << " tests, " << results.size() - failed
+                  << " passed, " << failed << " failed (" << std::fixed << std::setprecision(2)
+                  << seconds * 1000 << " ms, " << options.threads << " threads)" << std::endl;
+
+        std::vector<BenchResult> bench_results;
+        if (!benchmarks.empty()) {
+            std::cout << "\n" << std::left << std::setw(40) << "benchmark" << std::right
+                      << std::setw(12) << "min ns" << std::setw(12) << "median ns"
+                      << std::setw(12) << "p90 ns" << std::setw(12) << "p99 ns"
+                      << std::setw(12) << "max ns" << "\n";
+            for (const auto* test : benchmarks) {
+                bench_results.push_back(RunBenchmark(*test, options));
+                PrintBenchmark(bench_results.back());
+            }
+        }
+
+        bool written = true;
+        if (!options.junit_path.empty()) {
+            std::ofstream out(options.junit_path);
+            WriteJUnit(out, results, seconds);
+            written &= static_cast<bool>(out);
+        }
+        if (!options.json_path.empty()) {
+            std::ofstream out(options.json_path);
+            WriteJson(out, results, bench_results, seconds);
+            written &= static_cast<bool>(out);
+        }
+        if (!written) {
+            std::cerr << "could not write the report" << std::endl;
+            return 2;
+        }
+        return failed == 0 ? 0 : 1;
+    }
+
+    // Glob match with * and ?
+    static bool Glob(const char* pattern, const char* text) {
+        if (*pattern == '\0') {
+            return *text == '\0';
+        }
+        if (*pattern == '*') {
+            return Glob(pattern + 1, text) || (*text != '\0' && Glob(pattern, text + 1));
+        }
+        return *text != '\0' && (*pattern == '?' || *pattern == *text) && Glob(pattern + 1, text + 1);
+    }
+
+    static bool Matches(const std::string& name, const std::vector<std::string>& filters) {
+        bool any_positive = false, included = false;
+        for (const std::string& filter : filters) {
+            if (!filter.empty() && filter[0] == '-') {
+                if (Glob(filter.c_str() + 1, name.c_str())) {
+                    return false;
+                }
+            } else {
+                any_positive = true;
+                included |= Glob(filter.c_str(), name.c_str());
+            }
+        }
+        return included || !any_positive;
+    }
+
+    static std::vector<CaseResult> RunTests(const std::vector<const TestRegistry::TestCase*>& tests,
+                                            unsigned threads) {
+        std::vector<CaseResult> results(tests.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t i = next++; i < tests.size(); i = next++) {
+                results[i] = RunTest(*tests[i]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < std::min<size_t>(threads, tests.size()); t++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        return results;
+    }
+
+    static CaseResult RunTest(const TestRegistry::TestCase& test) {
+        CaseResult result;
+        result.test = &test;
+        TestFixture::running_test_results = &result.checks;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            test.function();
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        } catch (...) {
+            result.error = "unknown exception";
+        }
+        result.seconds = SecondsSince(start);
+        TestFixture::running_test_results = nullptr;
+        result.passed = result.error.empty() &&
+                        std::all_of(result.checks.begin(), result.checks.end(),
+                                    [](const TestFixture::TestResult& r) { return r.passed; });
+        return result;
+    }
+
+    // Calls per sample are doubled until a sample takes 20µs, so short
+    // bodies are timed in batches; the first samples are warmup
+    static BenchResult RunBenchmark(const TestRegistry::TestCase& test, const Options& options) {
+        BenchResult result;
+        result.test = &test;
+        size_t iterations = 1;
+        while (TimeCalls(test, iterations) < 20000 && iterations < (1u << 24)) {
+            iterations *= 2;
+        }
+        for (size_t i = 0; i < options.warmup; i++) {
+            TimeCalls(test, iterations);
+        }
+        std::vector<double> samples;
+        for (size_t i = 0; i < options.samples; i++) {
+            samples.push_back(TimeCalls(test, iterations) / static_cast<double>(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+        result.iterations = iterations;
+        result.samples = samples.size();
+        result.min_ns = samples.front();
+        result.median_ns = Percentile(samples, 0.5);
+        result.p90_ns = Percentile(samples, 0.9);
+        result.p99_ns = Percentile(samples, 0.99);
+        result.max_ns = samples.back();
+        return result;
+    }
 
+    static void WriteJUnit(std::ostream& out, const std::vector<CaseResult>& results, double seconds) {
+        size_t failures = std::count_if(results.begin(), results.end(),
+                                        [](const CaseResult& r) { return !r.passed; });
+        out << std::fixed << std::setprecision(6);
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            << "<testsuites tests=\"" << results.size() << "\" failures=\"" << failures
+            << "\" time=\"" << seconds << "\">\n";
+        // One suite per group, in order of first appearance
+        std::vector<std::string> groups;
+        for (const CaseResult& r : results) {
+            if (std::find(groups.begin(), groups.end(), r.test->group) == groups.end()) {
+                groups.push_back(r.test->group);
+            }
+        }
+        for (const std::string& group : groups) {
+            size_t tests = 0, failed = 0;
+            double time = 0;
+            for (const CaseResult& r : results) {
+                if (group == r.test->group) {
+                    tests++;
+                    failed += !r.passed;
+                    time += r.seconds;
+                }
+            }
+            out << "  <testsuite name=\"" << Escape(group, true) << "\" tests=\"" << tests
+                << "\" failures=\"" << failed << "\" time=\"" << time << "\">\n";
+            for (const CaseResult& r : results) {
+                if (group != r.test->group) {
+                    continue;
+                }
+                out << "    <testcase classname=\"" << Escape(group, true) << "\" name=\""
+                    << Escape(r.test->name, true) << "\" file=\"" << Escape(r.test->file, true)
+                    << "\" line=\"" << r.test->line << "\" time=\"" << r.seconds << "\"";
+                if (r.passed) {
+                    out << "/>\n";
+                    continue;
+                }
+                out << ">\n";
+                for (const std::string& failure : Failures(r)) {
+                    out << "      <failure message=\"" << Escape(failure, true) << "\"/>\n";
+                }
+                out << "    </testcase>\n";
+            }
+            out << "  </testsuite>\n";
+        }
+        out << "</testsuites>\n";
+    }
+
+    static void WriteJson(std::ostream& out, const std::vector<CaseResult>& results,
+                          const std::vector<BenchResult>& benchmarks, double seconds) {
+        out << std::fixed << std::setprecision(6);
+        out << "{\n  \"seconds\": " << seconds << ",\n  \"tests\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const CaseResult& r = results[i];
+            out << "    {\"group\": \"" << Escape(r.test->group, false) << "\", \"name\": \""
+                << Escape(r.test->name, false) << "\", \"passed\": " << (r.passed ? "true" : "false")
+                << ", \"seconds\": " << r.seconds;
+            if (!r.error.empty()) {
+                out << ", \"error\": \"" << Escape(r.error, false) << "\"";
+            }
+            out << ", \"checks\": [";
+            for (size_t c = 0; c < r.checks.size(); c++) {
+                const TestFixture::TestResult& check = r.checks[c];
+                out << (c > 0 ? ", " : "") << "{\"message\": \"" << Escape(check.message, false)
+                    << "\", \"passed\": " << (check.passed ? "true" : "false")
+                    << ", \"value\": \"" << Escape(check.value, false) << "\"}";
+            }
+            out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < benchmarks.size(); i++) {
+            const BenchResult& b = benchmarks[i];
+            out << "    {\"group\": \"" << Escape(b.test->group, false) << "\", \"name\": \""
+                << Escape(b.test->name, false) << "\", \"iterations\": " << b.iterations
+                << ", \"samples\": " << b.samples << ", \"min_ns\": " << b.min_ns
+                << ", \"median_ns\": " << b.median_ns << ", \"p90_ns\": " << b.p90_ns
+                << ", \"p99_ns\": " << b.p99_ns << ", \"max_ns\": " << b.max_ns << "}"
+                << (i + 1 < benchmarks.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+private:
+    static double SecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static double TimeCalls(const TestRegistry::TestCase& test, size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            test.function();
+        }
+        asm volatile("" : : : "memory");
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    // Nearest rank, of sorted samples
+    static double Percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+
+    static std::vector<std::string> Failures(const CaseResult& r) {
+        std::vector<std::string> failures;
+        if (!r.error.empty()) {
+            failures.push_back("uncaught exception: " + r.error);
+        }
+        for (const TestFixture::TestResult& check : r.checks) {
+            if (!check.passed) {
+                failures.push_back(check.value.empty() ? check.message
+                                                       : check.message + " (got " + check.value + ")");
+            }
+        }
+        return failures;
+    }
+
+    static void Report(const std::vector<CaseResult>& results, TestFixture::Verbosity verbosity) {
+        for (const CaseResult& r : results) {
+            std::cout << (r.passed ? "\033[32m[PASSED]\033[0m " : "\033[31m[FAILED]\033[0m ")
+                      << r.test->FullName() << " (" << std::fixed << std::setprecision(3)
+                      << r.seconds * 1000 << " ms)" << std::endl;
+            for (const TestFixture::TestResult& check : r.checks) {
+                if (verbosity == TestFixture::Verbose || !check.passed) {
+                    std::cout << "    ";
+                    TestFixture::PrintResult(check);
+                }
+            }
+            if (!r.error.empty()) {
+                std::cout << "    uncaught exception: " << r.error << std::endl;
+            }
+        }
+    }
+
+    static void PrintBenchmark(const BenchResult& b) {
+        std::cout << std::left << std::setw(40) << b.test->FullName() << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << b.min_ns << std::setw(12)
+                  << b.median_ns << std::setw(12) << b.p90_ns << std::setw(12) << b.p99_ns
+                  << std::setw(12) << b.max_ns << std::endl;
+    }
+
+    static std::vector<std::string> Split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        std::stringstream in(text);
+        std::string part;
+        while (std::getline(in, part, separator)) {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    // For XML attributes or JSON strings
+    static std::string Escape(const std::string& text, bool xml) {
+        std::string out;
+        for (char c : text) {
+            if (xml) {
+                switch (c) {
+                    case '&': out += "&amp;"; break;
+                    case '<': out += "&lt;"; break;
+                    case '>': out += "&gt;"; break;
+                    case '"': out += "&quot;"; break;
+                    default: out += c;
+                }
+            } else if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", c);
+                out += code;
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+};
+
+// Defines a test and registers it with TestRunner
 #define DEFINE_TEST_G(name, group) \
+    void TEST_##name##_##group(); \
+    static TestRegistry::Registrar registrar_TEST_##name##_##group( \
+        {#group, #name, TEST_##name##_##group, __FILE__, __LINE__, false}); \
     void TEST_##name##_##group()
 
+// Defines a benchmark: TestRunner --bench times calls of the body
+#define BENCH_G(name, group) \
+    void BENCH_##name##_##group(); \
+    static TestRegistry::Registrar registrar_BENCH_##name##_##group( \
+        {#group, #name, BENCH_##name##_##group, __FILE__, __LINE__, true}); \
+    void BENCH_##name##_##group()
+
 #define TEST_MESSAGE(condition, message) \
     TestFixture::AddTestResult(message, condition)
 
@@ -75,10 +565,10 @@ std::string TestFixture::current_test_name;
     { \
         auto a = actual; \
         auto e = expected; \
-        bool passed = (a == e); \
+        bool passed = TestFixture::Equal(a, e); \
         std::ostringstream value; \
         value << a; \
         TestFixture::AddTestResult(message, passed, value.str()); \
     }
 
-#endif // SIMPLETEST_H 
\ No newline at end of file
+#endif // SIMPLETEST_H
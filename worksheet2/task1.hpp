@@ -1,67 +1,63 @@
-#ifndef BUMP_ALLOCATOR_HPP
-#define BUMP_ALLOCATOR_HPP
+#ifndef WORKSHEET2_TASK1_HPP
+#define WORKSHEET2_TASK1_HPP
+
+#include "../allocator/bump_allocator.hpp"
 
 #include <cstddef>
 #include <cstdint>
 
-template<size_t N>
+// Worksheet interface over bump<N, Growth>. With bump_growth::fixed (the
+// default) the N bytes live inside the object; with bump_growth::chained the
+// arena starts with an N byte heap chunk and grows on demand.
+template<size_t N, bump_growth Growth = bump_growth::fixed>
 class BumpAllocator {
 private:
-    char memory_[N];           // Fixed size memory chunk
-    char* next_;               // Bump pointer
-    size_t allocations_;       // Counter for allocations
+    bump<N, Growth> arena_;    // Backing arena
 
 public:
-    BumpAllocator() : next_(memory_), allocations_(0) {}
+    BumpAllocator() = default;
 
     template<typename T>
     T* alloc(size_t n = 1) {
         // Calculate total size needed
-        size_t size = sizeof(T) * n;
-        
-        // Check if we have enough space
-        if (next_ + size > memory_ + N) {
+        if (n > SIZE_MAX / sizeof(T)) {
             return nullptr;
         }
+        size_t size = sizeof(T) * n;
+
+        // Bump the pointer, padding up to alignof(T)
+        return static_cast<T*>(arena_.allocate(size, alignof(T)));
+    }
+
+    // Save the current position
+    bump_marker mark() const {
+        return arena_.mark();
+    }
 
-        // Save current position
-        T* result = reinterpret_cast<T*>(next_);
-        
-        // Bump the pointer
-        next_ += size;
-        
-        // Increment allocation counter
-        ++allocations_;
-        
-        return result;
+    // Free everything allocated since the marker was taken
+    void rewind(const bump_marker& marker) {
+        arena_.rewind(marker);
     }
 
     void dealloc() {
-        // Decrement allocation counter
-        if (allocations_ > 0) {
-            --allocations_;
-            
-            // If all allocations are freed, reset the bump pointer
-            if (allocations_ == 0) {
-                next_ = memory_;
-            }
-        }
+        // If all allocations are freed, the arena resets its bump pointer
+        arena_.dealloc();
     }
 
-    // Static method to get the total capacity
+    // Static method to get the total capacity (initial chunk when chained)
     static constexpr size_t capacity() {
         return N;
     }
 
     // Method to get current number of allocations
     size_t allocations() const {
-        return allocations_;
+        return arena_.get_allocation_count();
     }
 
-    // Method to get remaining space
+    // Method to get remaining space in the current buffer
     size_t remaining_space() const {
-        return N - (next_ - memory_);
+        return arena_.get_available_space();
     }
 };
 
-#endif // BUMP_ALLOCATOR_HPP 
\ No newline at end of file
+#endif // WORKSHEET2_TASK1_HPP
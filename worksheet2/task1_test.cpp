@@ -1,81 +1,88 @@
 #include "task1.hpp"
-#include <iostream>
+#include <simpletest.h>
+#include <cstring>
+#include <sstream>
 #include <string>
 
 // Test different allocation sizes
-void test_different_sizes() {
-    std::cout << "Testing different allocation sizes..." << std::endl;
-    
+DEFINE_TEST_G(DifferentSizes, Task1) {
     BumpAllocator<1024> allocator;
-    
+
     // Allocate an int
     int* i = allocator.alloc<int>();
+    TEST_MESSAGE(i != nullptr, "Int allocation should succeed");
     if (i != nullptr) {
         *i = 42;
-        std::cout << "Allocated int: " << *i << std::endl;
+        TEST_EQUAL(*i, 42, "Allocated int should hold its value");
     }
-    
+
     // Allocate a double
     double* d = allocator.alloc<double>();
+    TEST_MESSAGE(d != nullptr, "Double allocation should succeed");
     if (d != nullptr) {
         *d = 3.14;
-        std::cout << "Allocated double: " << *d << std::endl;
+        TEST_EQUAL(*d, 3.14, "Allocated double should hold its value");
     }
-    
+
     // Allocate an array of chars
     char* str = allocator.alloc<char>(10);
+    TEST_MESSAGE(str != nullptr, "Char array allocation should succeed");
     if (str != nullptr) {
         strcpy(str, "Hello");
-        std::cout << "Allocated string: " << str << std::endl;
+        TEST_EQUAL(std::string(str), std::string("Hello"), "Allocated string should hold its value");
     }
-    
-    std::cout << "Remaining space: " << allocator.remaining_space() << " bytes" << std::endl;
+
+    // The double starts at the int's end rounded up to its alignment; the
+    // chars follow it directly
+    size_t double_offset = (sizeof(int) + alignof(double) - 1) / alignof(double) * alignof(double);
+    TEST_EQUAL(allocator.remaining_space(), 1024 - (double_offset + sizeof(double) + 10),
+               "Remaining space should account for alignment padding");
 }
 
 // Test allocation failure
-void test_allocation_failure() {
-    std::cout << "\nTesting allocation failure..." << std::endl;
-    
+DEFINE_TEST_G(AllocationFailure, Task1) {
     BumpAllocator<16> small_allocator;
-    
+
     // Try to allocate more than available
     int* arr = small_allocator.alloc<int>(5);  // 20 bytes needed
-    if (arr == nullptr) {
-        std::cout << "Allocation failed as expected" << std::endl;
-    }
+    TEST_MESSAGE(arr == nullptr, "Allocation beyond capacity should fail");
+    TEST_EQUAL(small_allocator.allocations(), 0, "Failed allocation should not be counted");
 }
 
 // Test allocator reset
-void test_allocator_reset() {
-    std::cout << "\nTesting allocator reset..." << std::endl;
-    
+DEFINE_TEST_G(AllocatorReset, Task1) {
     BumpAllocator<64> allocator;
-    
+
     // Make some allocations
-    int* i1 = allocator.alloc<int>();
-    int* i2 = allocator.alloc<int>();
-    
-    std::cout << "Number of allocations: " << allocator.allocations() << std::endl;
-    std::cout << "Remaining space before dealloc: " << allocator.remaining_space() << std::endl;
-    
+    allocator.alloc<int>();
+    allocator.alloc<int>();
+    TEST_EQUAL(allocator.allocations(), 2, "Number of allocations should be 2");
+    TEST_EQUAL(allocator.remaining_space(), 64 - 2 * sizeof(int),
+               "Remaining space before dealloc should be reduced");
+
     // Deallocate
     allocator.dealloc();
     allocator.dealloc();
-    
-    std::cout << "After deallocating all, remaining space: " << allocator.remaining_space() << std::endl;
-    
+    TEST_EQUAL(allocator.remaining_space(), 64, "Deallocating all should reset the space");
+
     // Try new allocation after reset
     int* i3 = allocator.alloc<int>();
+    TEST_MESSAGE(i3 != nullptr, "Allocation after reset should succeed");
     if (i3 != nullptr) {
         *i3 = 100;
-        std::cout << "Successfully allocated after reset: " << *i3 << std::endl;
+        TEST_EQUAL(*i3, 100, "Allocation after reset should hold its value");
     }
 }
 
-int main() {
-    test_different_sizes();
-    test_allocation_failure();
-    test_allocator_reset();
-    
-    return 0;
-} 
\ No newline at end of file
+// One allocate-and-free cycle
+BENCH_G(AllocDealloc, Task1) {
+    static BumpAllocator<1024> allocator;
+    int* i = allocator.alloc<int>();
+    TestFixture::DoNotOptimize(i);
+    allocator.dealloc();
+}
+
+// usage: task1_test [--filter PATTERNS] [--threads N] [--junit FILE] [--json FILE] [--bench]
+int main(int argc, char** argv) {
+    return TestRunner::Run(argc, argv);
+}
@@ -3,32 +3,6 @@
 #include <iostream>
 #include <sstream>
 
-// Forward declarations of test functions
-void TEST_BasicAllocation_BumpAllocator();
-void TEST_AllocationFailure_BumpAllocator();
-void TEST_MultipleAllocations_BumpAllocator();
-void TEST_DeallocationReset_BumpAllocator();
-void TEST_RemainingSpace_BumpAllocator();
-
-// Test group definitions
-struct TestGroup {
-    const char* name;
-    std::vector<std::function<void()>> tests;
-};
-
-TestGroup test_groups[] = {
-    {
-        "BumpAllocator",
-        {
-            TEST_BasicAllocation_BumpAllocator,
-            TEST_AllocationFailure_BumpAllocator,
-            TEST_MultipleAllocations_BumpAllocator,
-            TEST_DeallocationReset_BumpAllocator,
-            TEST_RemainingSpace_BumpAllocator
-        }
-    }
-};
-
 // Test basic allocation
 DEFINE_TEST_G(BasicAllocation, BumpAllocator) {
     BumpAllocator<1024> allocator;
@@ -87,8 +61,8 @@ DEFINE_TEST_G(DeallocationReset, BumpAllocator) {
     BumpAllocator<64> allocator;
     size_t initial_space = allocator.remaining_space();
     
-    int* x = allocator.alloc<int>();
-    int* y = allocator.alloc<int>();
+    allocator.alloc<int>();
+    allocator.alloc<int>();
     
     TEST_EQUAL(allocator.allocations(), 2, "Should have 2 allocations initially");
     
@@ -118,25 +92,18 @@ DEFINE_TEST_G(RemainingSpace, BumpAllocator) {
     
     TEST_EQUAL(initial_space, 100, "Initial space should be 100 bytes");
     
-    int* x = allocator.alloc<int>();
+    allocator.alloc<int>();
     TEST_EQUAL(allocator.remaining_space(), initial_space - sizeof(int),
                "Remaining space should decrease by sizeof(int)");
     
-    double* d = allocator.alloc<double>();
-    TEST_EQUAL(allocator.remaining_space(), initial_space - sizeof(int) - sizeof(double),
-               "Remaining space should decrease by sizeof(double)");
+    // The double starts at the int's end rounded up to its alignment
+    allocator.alloc<double>();
+    size_t double_offset = (sizeof(int) + alignof(double) - 1) / alignof(double) * alignof(double);
+    TEST_EQUAL(allocator.remaining_space(), initial_space - (double_offset + sizeof(double)),
+               "Remaining space should decrease by sizeof(double) plus padding");
 }
 
-int main() {
-    bool pass = true;
-    
-    for (const auto& group : test_groups) {
-        std::cout << "\nRunning test group: " << group.name << "\n";
-        for (const auto& test : group.tests) {
-            test();
-        }
-        pass &= TestFixture::ExecuteTestGroup(group.name, TestFixture::Verbose);
-    }
-    
-    return pass ? 0 : 1;
-} 
\ No newline at end of file
+// usage: worksheet2_task2 [--filter PATTERNS] [--threads N] [--junit FILE] [--json FILE] [--bench]
+int main(int argc, char** argv) {
+    return TestRunner::Run(argc, argv);
+}
@@ -1,40 +1,61 @@
 #include "task3.hpp"
 #include "task1.hpp"
+#include "../allocator/double_ended_arena.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <vector>
 #include <memory>
-
-// Bump allocator that grows upward
-template<size_t N>
-class BumpUpAllocator : public BumpAllocator<N> {};
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 // Bump allocator that grows downward
 template<size_t N>
 class BumpDownAllocator {
 private:
-    char memory_[N];
+    char* memory_;             // Heap buffer, so nothing large sits on the stack
     char* next_;
     size_t allocations_;
 
 public:
-    BumpDownAllocator() : next_(memory_ + N), allocations_(0) {}
+    BumpDownAllocator() : memory_(new char[N]), next_(memory_ + N), allocations_(0) {}
+
+    ~BumpDownAllocator() {
+        delete[] memory_;
+    }
+
+    BumpDownAllocator(const BumpDownAllocator&) = delete;
+    BumpDownAllocator& operator=(const BumpDownAllocator&) = delete;
 
     template<typename T>
     T* alloc(size_t n = 1) {
-        size_t size = sizeof(T) * n;
-        
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    // Untyped allocation; align must be a power of two
+    void* allocate(size_t size, size_t align) {
         // Check if we have enough space
-        if (next_ - size < memory_) {
+        if (size > static_cast<size_t>(next_ - memory_)) {
+            return nullptr;
+        }
+
+        // Move pointer down, then round down to align
+        uintptr_t address = reinterpret_cast<uintptr_t>(next_) - size;
+        address &= ~(uintptr_t(align) - 1);
+        if (address < reinterpret_cast<uintptr_t>(memory_)) {
             return nullptr;
         }
-        
-        // Move pointer down
-        next_ -= size;
-        
+        next_ = reinterpret_cast<char*>(address);
+
         // Increment allocation counter
         ++allocations_;
-        
-        return reinterpret_cast<T*>(next_);
+
+        return next_;
     }
 
     void dealloc() {
@@ -45,115 +66,225 @@ public:
             }
         }
     }
+
+    // Drop every allocation at once
+    void reset() {
+        allocations_ = 0;
+        next_ = memory_ + N;
+    }
 };
 
-// Benchmark functions
-void benchmark_small_allocations(size_t count) {
-    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
-    
-    // Test BumpUpAllocator
-    auto up_test = [count]() {
-        BumpUpAllocator<HEAP_SIZE> up_alloc;
-        for (size_t i = 0; i < count; ++i) {
-            auto ptr = up_alloc.alloc<char>();
-            if (ptr) *ptr = 'a';
-        }
-    };
-    
-    // Test BumpDownAllocator
-    auto down_test = [count]() {
-        BumpDownAllocator<HEAP_SIZE> down_alloc;
-        for (size_t i = 0; i < count; ++i) {
-            auto ptr = down_alloc.alloc<char>();
-            if (ptr) *ptr = 'a';
-        }
-    };
-    
-    auto up_result = Benchmark::run("BumpUpAllocator - Small Allocations", up_test, 10);
-    auto down_result = Benchmark::run("BumpDownAllocator - Small Allocations", down_test, 10);
-    
-    Benchmark::print_result(up_result);
-    Benchmark::print_result(down_result);
+// ---------------------------------------------------------------------------
+// Contenders. Each exposes allocate(bytes, align) and reset(), where reset()
+// ends a "request" and frees everything it allocated.
+
+constexpr size_t ARENA_SIZE = 4 * 1024 * 1024;
+
+struct FixedBump {
+    static constexpr const char* name = "bump (fixed)";
+    std::unique_ptr<bump<ARENA_SIZE>> arena{new bump<ARENA_SIZE>};   // Not zeroed
+    void* allocate(size_t bytes, size_t align) { return arena->allocate(bytes, align); }
+    void reset() { arena->reset(); }
+};
+
+struct ChainedBump {
+    static constexpr const char* name = "bump (chained)";
+    arena<64 * 1024> chunks;
+    void* allocate(size_t bytes, size_t align) { return chunks.allocate(bytes, align); }
+    void reset() { chunks.reset(); }
+};
+
+struct DownBump {
+    static constexpr const char* name = "bump down";
+    BumpDownAllocator<ARENA_SIZE> down;
+    void* allocate(size_t bytes, size_t align) { return down.allocate(bytes, align); }
+    void reset() { down.reset(); }
+};
+
+struct DoubleEnded {
+    static constexpr const char* name = "double-ended (temporary end)";
+    std::unique_ptr<double_ended_arena<ARENA_SIZE>> arena{new double_ended_arena<ARENA_SIZE>};
+    void* allocate(size_t bytes, size_t align) { return arena->temporary.allocate(bytes, align); }
+    void reset() { arena->temporary.reset(); }
+};
+
+// malloc has no bulk free, so every block is remembered and freed in reset()
+struct Malloc {
+    static constexpr const char* name = "malloc";
+    std::vector<void*> live;
+    Malloc() { live.reserve(16 * 1024); }
+    void* allocate(size_t bytes, size_t align) {
+        void* p = align <= alignof(std::max_align_t)
+            ? std::malloc(bytes)
+            : std::aligned_alloc(align, (bytes + align - 1) & ~(align - 1));
+        live.push_back(p);
+        return p;
+    }
+    void reset() {
+        for (void* p : live) std::free(p);
+        live.clear();
+    }
+};
+
+struct PmrMonotonic {
+    static constexpr const char* name = "pmr monotonic_buffer_resource";
+    std::pmr::monotonic_buffer_resource resource{64 * 1024};
+    void* allocate(size_t bytes, size_t align) { return resource.allocate(bytes, align); }
+    void reset() { resource.release(); }
+};
+
+struct PmrPool {
+    static constexpr const char* name = "pmr unsynchronized_pool_resource";
+    struct block { void* p; size_t bytes; size_t align; };
+    std::pmr::unsynchronized_pool_resource resource;
+    std::vector<block> live;
+    PmrPool() { live.reserve(16 * 1024); }
+    void* allocate(size_t bytes, size_t align) {
+        void* p = resource.allocate(bytes, align);
+        live.push_back({p, bytes, align});
+        return p;
+    }
+    void reset() {
+        for (const block& b : live) resource.deallocate(b.p, b.bytes, b.align);
+        live.clear();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Workloads. One call is one request: a run of allocations, then reset().
+
+template<typename Alloc>
+void touch(Alloc& a, size_t bytes, size_t align) {
+    char* p = static_cast<char*>(a.allocate(bytes, align));
+    p[0] = 1;
+    do_not_optimize(p);
 }
 
-void benchmark_large_allocations(size_t count) {
-    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
-    constexpr size_t ALLOC_SIZE = 1024;        // 1KB allocations
-    
-    // Test BumpUpAllocator
-    auto up_test = [count]() {
-        BumpUpAllocator<HEAP_SIZE> up_alloc;
-        for (size_t i = 0; i < count; ++i) {
-            auto ptr = up_alloc.alloc<char>(ALLOC_SIZE);
-            if (ptr) ptr[0] = 'a';
+struct Small {
+    static constexpr const char* name = "small";
+    static constexpr size_t ops = 10000;
+    template<typename Alloc>
+    static void run(Alloc& a) {
+        for (size_t i = 0; i < ops; ++i) touch(a, 16, 8);
+        a.reset();
+    }
+};
+
+struct Large {
+    static constexpr const char* name = "large";
+    static constexpr size_t ops = 200;
+    template<typename Alloc>
+    static void run(Alloc& a) {
+        for (size_t i = 0; i < ops; ++i) touch(a, 8192, 16);
+        a.reset();
+    }
+};
+
+struct Mixed {
+    static constexpr const char* name = "mixed";
+    static constexpr size_t ops = 5000;
+    template<typename Alloc>
+    static void run(Alloc& a) {
+        static constexpr size_t sizes[] = {8, 24, 64, 256, 1024};
+        for (size_t i = 0; i < ops; ++i) {
+            size_t bytes = sizes[i % 5];
+            touch(a, bytes, bytes < 16 ? bytes : 16);
         }
-    };
-    
-    // Test BumpDownAllocator
-    auto down_test = [count]() {
-        BumpDownAllocator<HEAP_SIZE> down_alloc;
-        for (size_t i = 0; i < count; ++i) {
-            auto ptr = down_alloc.alloc<char>(ALLOC_SIZE);
-            if (ptr) ptr[0] = 'a';
+        a.reset();
+    }
+};
+
+struct AlignmentHeavy {
+    static constexpr const char* name = "alignment-heavy";
+    static constexpr size_t ops = 5000;
+    template<typename Alloc>
+    static void run(Alloc& a) {
+        for (size_t i = 0; i < ops; ++i) touch(a, 24, 64);
+        a.reset();
+    }
+};
+
+struct ResetHeavy {
+    static constexpr const char* name = "reset-heavy";
+    static constexpr size_t ops = 2000;
+    template<typename Alloc>
+    static void run(Alloc& a) {
+        for (size_t i = 0; i < ops / 20; ++i) {
+            for (size_t j = 0; j < 20; ++j) touch(a, 32, 8);
+            a.reset();
         }
-    };
-    
-    auto up_result = Benchmark::run("BumpUpAllocator - Large Allocations", up_test, 10);
-    auto down_result = Benchmark::run("BumpDownAllocator - Large Allocations", down_test, 10);
-    
-    Benchmark::print_result(up_result);
-    Benchmark::print_result(down_result);
+    }
+};
+
+template<typename Workload, typename Alloc>
+void bench(std::vector<Benchmark::Result>& results, const Benchmark::Config& base) {
+    Alloc alloc;
+    Benchmark::Config config = base;
+    config.ops = Workload::ops;
+    results.push_back(Benchmark::run(std::string(Workload::name) + " / " + Alloc::name,
+                                     [&alloc] { Workload::run(alloc); }, config));
+    Benchmark::print_result(results.back());
 }
 
-void benchmark_mixed_allocations() {
-    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
-    
-    // Test BumpUpAllocator
-    auto up_test = []() {
-        BumpUpAllocator<HEAP_SIZE> up_alloc;
-        for (size_t i = 0; i < 1000; ++i) {
-            if (i % 2 == 0) {
-                auto ptr = up_alloc.alloc<char>();
-                if (ptr) *ptr = 'a';
-            } else {
-                auto ptr = up_alloc.alloc<int>();
-                if (ptr) *ptr = 42;
-            }
+template<typename Workload>
+void bench_all(std::vector<Benchmark::Result>& results, const Benchmark::Config& config) {
+    bench<Workload, FixedBump>(results, config);
+    bench<Workload, ChainedBump>(results, config);
+    bench<Workload, DownBump>(results, config);
+    bench<Workload, DoubleEnded>(results, config);
+    bench<Workload, Malloc>(results, config);
+    bench<Workload, PmrMonotonic>(results, config);
+    bench<Workload, PmrPool>(results, config);
+    std::cout << "\n";
+}
+
+int usage(const char* program) {
+    std::cerr << "usage: " << program << " [--reps N] [--warmup N] [--json FILE] [--csv FILE]\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    Benchmark::Config config;
+    std::string json_path;
+    std::string csv_path;
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "missing value for " << flag << "\n";
+            return usage(argv[0]);
         }
-    };
-    
-    // Test BumpDownAllocator
-    auto down_test = []() {
-        BumpDownAllocator<HEAP_SIZE> down_alloc;
-        for (size_t i = 0; i < 1000; ++i) {
-            if (i % 2 == 0) {
-                auto ptr = down_alloc.alloc<char>();
-                if (ptr) *ptr = 'a';
-            } else {
-                auto ptr = down_alloc.alloc<int>();
-                if (ptr) *ptr = 42;
-            }
+        if (flag == "--reps") {
+            config.repetitions = std::stoul(argv[i + 1]);
+        } else if (flag == "--warmup") {
+            config.warmup = std::stoul(argv[i + 1]);
+        } else if (flag == "--json") {
+            json_path = argv[i + 1];
+        } else if (flag == "--csv") {
+            csv_path = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << flag << "\n";
+            return usage(argv[0]);
         }
-    };
-    
-    auto up_result = Benchmark::run("BumpUpAllocator - Mixed Allocations", up_test, 10);
-    auto down_result = Benchmark::run("BumpDownAllocator - Mixed Allocations", down_test, 10);
-    
-    Benchmark::print_result(up_result);
-    Benchmark::print_result(down_result);
-}
+    }
+
+    std::cout << "Allocator suite: " << config.repetitions << " samples after "
+              << config.warmup << " warmup runs\n\n";
+    Benchmark::print_header();
 
-int main() {
-    std::cout << "Running benchmarks...\n\n";
-    
-    std::cout << "1. Small Allocations Test (10000 allocations)\n";
-    benchmark_small_allocations(10000);
-    
-    std::cout << "\n2. Large Allocations Test (100 allocations)\n";
-    benchmark_large_allocations(100);
-    
-    std::cout << "\n3. Mixed Allocations Test\n";
-    benchmark_mixed_allocations();
-    
+    std::vector<Benchmark::Result> results;
+    bench_all<Small>(results, config);
+    bench_all<Large>(results, config);
+    bench_all<Mixed>(results, config);
+    bench_all<AlignmentHeavy>(results, config);
+    bench_all<ResetHeavy>(results, config);
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        Benchmark::write_json(out, results);
+    }
+    if (!csv_path.empty()) {
+        std::ofstream out(csv_path);
+        Benchmark::write_csv(out, results);
+    }
     return 0;
-} 
\ No newline at end of file
+}
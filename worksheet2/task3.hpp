@@ -1,63 +1,169 @@
 #ifndef BENCHMARK_HPP
 #define BENCHMARK_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
 #include <string>
-#include <functional>
+#include <utility>
 #include <vector>
-#include <iostream>
 
+// Keep value alive and opaque to the optimizer, so the work that produced it
+// cannot be deleted or hoisted out of the timed loop
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template<typename T>
+inline void do_not_optimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// Force pending stores to memory to count as observable
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Repeated-sample benchmark runner. Each sample times `iterations` calls of
+// the function with a nanosecond steady clock, after `warmup` untimed calls.
+// Results carry min/median/p99/mean/stddev per sample and per operation,
+// and can be printed or written as JSON or CSV.
 class Benchmark {
 public:
-    // Function to measure execution time of a void function
-    template<typename Func>
-    static auto measure(Func&& func) {
-        using namespace std::chrono;
-        
-        auto start = high_resolution_clock::now();
-        std::forward<Func>(func)();
-        auto end = high_resolution_clock::now();
-        
-        return duration_cast<microseconds>(end - start);
-    }
-    
-    // Function to run multiple iterations and get average time
-    template<typename Func>
-    static auto measure_average(Func&& func, size_t iterations) {
-        using namespace std::chrono;
-        
-        microseconds total(0);
-        for (size_t i = 0; i < iterations; ++i) {
-            total += measure(func);
-        }
-        
-        return microseconds(total.count() / iterations);
-    }
-    
-    // Struct to hold benchmark results
+    struct Config {
+        size_t warmup = 3;          // Untimed calls before sampling
+        size_t repetitions = 30;    // Samples
+        size_t iterations = 1;      // Calls per sample
+        size_t ops = 1;             // Operations per call, for ns/op
+    };
+
     struct Result {
         std::string name;
-        std::chrono::microseconds time;
-        size_t iterations;
-        
-        Result(const std::string& n, std::chrono::microseconds t, size_t i)
-            : name(n), time(t), iterations(i) {}
+        size_t repetitions = 0;
+        size_t iterations = 0;
+        size_t ops = 0;
+        double min_ns = 0;          // All per sample
+        double median_ns = 0;
+        double p99_ns = 0;
+        double mean_ns = 0;
+        double stddev_ns = 0;
+
+        // Median cost of one operation
+        double ns_per_op() const {
+            return median_ns / static_cast<double>(iterations * ops);
+        }
     };
-    
-    // Function to run and record a benchmark
+
     template<typename Func>
-    static Result run(const std::string& name, Func&& func, size_t iterations = 1) {
-        auto time = measure_average(std::forward<Func>(func), iterations);
-        return Result(name, time, iterations);
+    static Result run(const std::string& name, Func&& func, const Config& config = Config()) {
+        using clock = std::chrono::steady_clock;
+
+        for (size_t i = 0; i < config.warmup; ++i) {
+            func();
+        }
+
+        std::vector<double> samples;
+        samples.reserve(config.repetitions);
+        for (size_t r = 0; r < config.repetitions; ++r) {
+            auto start = clock::now();
+            for (size_t i = 0; i < config.iterations; ++i) {
+                func();
+            }
+            clobber_memory();
+            auto end = clock::now();
+            samples.push_back(static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+        return summarize(name, std::move(samples), config);
+    }
+
+    static void print_header(std::ostream& out = std::cout) {
+        out << std::left << std::setw(44) << "benchmark" << std::right
+            << std::setw(12) << "min ns" << std::setw(12) << "median ns"
+            << std::setw(12) << "p99 ns" << std::setw(12) << "stddev"
+            << std::setw(10) << "ns/op" << "\n";
+    }
+
+    static void print_result(const Result& result, std::ostream& out = std::cout) {
+        out << std::left << std::setw(44) << result.name << std::right << std::fixed
+            << std::setprecision(0)
+            << std::setw(12) << result.min_ns << std::setw(12) << result.median_ns
+            << std::setw(12) << result.p99_ns << std::setw(12) << result.stddev_ns
+            << std::setprecision(2) << std::setw(10) << result.ns_per_op() << "\n";
+        out.unsetf(std::ios::fixed);
+        out << std::setprecision(6);
+    }
+
+    static void write_json(std::ostream& out, const std::vector<Result>& results) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "  {\"name\": \"" << escape(r.name) << "\""
+                << ", \"repetitions\": " << r.repetitions
+                << ", \"iterations\": " << r.iterations
+                << ", \"ops\": " << r.ops
+                << ", \"min_ns\": " << r.min_ns
+                << ", \"median_ns\": " << r.median_ns
+                << ", \"p99_ns\": " << r.p99_ns
+                << ", \"mean_ns\": " << r.mean_ns
+                << ", \"stddev_ns\": " << r.stddev_ns
+                << ", \"ns_per_op\": " << r.ns_per_op() << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+
+    static void write_csv(std::ostream& out, const std::vector<Result>& results) {
+        out << "name,repetitions,iterations,ops,min_ns,median_ns,p99_ns,mean_ns,stddev_ns,ns_per_op\n";
+        for (const Result& r : results) {
+            out << "\"" << r.name << "\"," << r.repetitions << "," << r.iterations << ","
+                << r.ops << "," << r.min_ns << "," << r.median_ns << "," << r.p99_ns << ","
+                << r.mean_ns << "," << r.stddev_ns << "," << r.ns_per_op() << "\n";
+        }
     }
-    
-    // Function to print benchmark results
-    static void print_result(const Result& result) {
-        std::cout << result.name << ": "
-                  << result.time.count() << " microseconds "
-                  << "(averaged over " << result.iterations << " iterations)"
-                  << std::endl;
+
+private:
+    static Result summarize(const std::string& name, std::vector<double> samples,
+                            const Config& config) {
+        Result result;
+        result.name = name;
+        result.repetitions = samples.size();
+        result.iterations = config.iterations;
+        result.ops = config.ops;
+        if (samples.empty()) {
+            return result;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+        result.min_ns = samples.front();
+        result.median_ns = n % 2 == 1 ? samples[n / 2]
+                                      : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        // Nearest-rank percentile
+        size_t rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(n)));
+        result.p99_ns = samples[rank > 0 ? rank - 1 : 0];
+
+        double sum = 0;
+        for (double s : samples) sum += s;
+        result.mean_ns = sum / static_cast<double>(n);
+        double squares = 0;
+        for (double s : samples) squares += (s - result.mean_ns) * (s - result.mean_ns);
+        result.stddev_ns = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0;
+        return result;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
     }
 };
 
-#endif // BENCHMARK_HPP 
\ No newline at end of file
+#endif // BENCHMARK_HPP